@@ -66,4 +66,125 @@
 #define DEFINE_RELAY P2 ^ 3  // 继电器
 #define DEFINE_BUZZER P1 ^ 4 // 蜂鸣器
 
+// ------- define for boot ----------
+
+// #define BOOT_SKIP_SPLASH // 跳过开机动画 直接显示主视图
+
+// ------- define for history ----------
+
+#define HISTORY_SIZE  16    // 温度历史采样个数 (一行 16 列 2 的幂)
+#define HISTORY_TICKS 54000 // 采样间隔 T0 节拍数 (15s 共约 4 分钟)
+#define HISTORY_EMPTY -128  // 还没有采样
+
+// ------- define for checkpoint ----------
+
+/**
+ * 极值与越界计时写入 24c02 的频率 (单位: 温度历史采样间隔 15s)
+ * 新的极值 或越界结束: 距上次写入至少 CHECKPOINT_MIN_AGE
+ * 越界期间计时改变:   距上次写入至少 CHECKPOINT_MAX_AGE
+ * 最坏每分钟写一次 两个槽交替 每个槽 100 万次约 3.8 年
+ */
+#define CHECKPOINT_MIN_AGE 4  // 1 分钟
+#define CHECKPOINT_MAX_AGE 40 // 10 分钟
+
+// ------- define for uart ----------
+
+/**
+ * 串口遥测 (uart.h) T1 方式2 产生波特率 TXD(P3.1) 输出 (按键只用 P3.2-P3.7)
+ * 每 TELEMETRY_EVERY 次温度转换发送一个采样帧 越界 恢复等事件立即发送
+ * 帧的内容见 ultimate.c 中 Telemetry_Sample Telemetry_Event
+ * 默认不编译: 另占 5 字节 data 和 UART_TX_SIZE 字节 idata
+ * 基线构建栈只剩 39 字节 (sim51 实测最多用到约 36) 这组改动的 RAM 增长之后栈已不够同时开启
+ * 开启前用 map51 -s 和 sim51 -s 检查栈余量 不够时减小 UART_TX_SIZE 或 MUSIC_BUF_SIZE
+ */
+// #define UART_TELEMETRY
+#define UART_RELOAD     0xfd // 11.0592MHz SMOD = 0 时 9600 波特
+#define UART_TX_SIZE    32   // 发送缓冲字节数 (2 的幂 一个采样帧 11 字节)
+#define TELEMETRY_EVERY 1    // 1: 每次温度转换都发送采样
+
+/**
+ * Modbus RTU 从机 (modbus.h) 与串口遥测使用同一个串口 二选一
+ * 帧间静默 3.5 个字符 (9600 波特 约 3.65ms) 由 T0 节拍计时 设置模式中 T0 停止 不应答
+ * 读取温度时关中断约 6.7ms (写入了设置时约 11ms) 期间收到的字节只能保留 1 个 与之重叠的请求整帧丢弃 不应答 (主机超时重发)
+ */
+// #define UART_MODBUS
+#define MODBUS_ADDR     1  // 从机地址
+#define MODBUS_T35      15 // 3.5 个字符的 T0 节拍数 (13.1 向上取整再加 1 重新计时后第一个节拍可能马上到来)
+#define MODBUS_BUF_SIZE 24 // 最长的请求/应答 21 字节
+
+#if defined(UART_TELEMETRY) && defined(UART_MODBUS)
+#error "UART_TELEMETRY and UART_MODBUS share the UART"
+#endif
+
+// ------- define for diag ----------
+
+/**
+ * 运行时诊断 (diag.h) 中断的响应延迟/执行时间 主循环一次的最长时间 CPU 占用
+ * 在设置查询视图再按一次 S4 进入诊断视图 不定义时全部不编译
+ * 开启后 T0 最长路径约多 40 个机器周期 另占约 27 字节 RAM
+ */
+// #define DIAG_ENABLE
+#define STACK_PAINT 0x55 // 开机时填充栈空间的值 (诊断中查询栈用到的最高处)
+
+/**
+ * 事件追踪 (trace.h) 最近 TRACE_SIZE 条带节拍的记录 进入设置模式时经串口遥测发送
+ * TRACE_ISR 选择记录进出的中断: 0x01 T0 0x02 T2 0x04 串口 0x08 X0
+ */
+// #define TRACE_ENABLE
+#define TRACE_SIZE 8    // 记录条数 (2 的幂 每条 4 字节 idata)
+#define TRACE_ISR  0x08
+
+#if defined(TRACE_ENABLE) && !defined(UART_TELEMETRY)
+#error "TRACE_ENABLE is dumped through UART_TELEMETRY"
+#endif
+
+// ------- define for 24c02 ----------
+
+#define AT24C02_SLA 0xa0 // 24c02 器件地址码
+
+/**
+ * 24c02 存储分布 (256字节 每页16字节) 初始镜像由 tools/eepromc 生成
+ *   0x00      旧版本的设置 (风扇档位步长 铃声序号 铃声速率) 没有有效的配置记录时迁移
+ *             镜像加载不写入 空白时 (0xff) 使用镜像中的出厂设置
+ *   0x01-0x02 镜像标记 EE_IMAGE_MAGIC 和镜像版本
+ *   0x03-0x07 乐谱起始地址表 后一首的起始地址即为前一首的结尾 (最多4首)
+ *   0x08-0x8f 乐谱
+ *   0x90-0x94 控制参数 (control.h 中 ctrlParam 的顺序)
+ *   0x95-0x9f 保留
+ *   0xa0-0xa7 配置记录 A (设置模式中的 6 项 带版本和 CRC)
+ *   0xa8-0xaf 配置记录 B (A 的副本 先写 A 再写 B)
+ *   0xb0-0xb9 检查点 A (极值 越界计时)
+ *   0xc0-0xc9 检查点 B
+ *   0xd0-0xff 日志
+ */
+#define EE_SETTINGS     0x00
+#define EE_IMAGE_TAG    0x01
+#define EE_MUSIC_TABLE  0x03
+#define EE_MUSIC        0x08
+#define EE_CONTROL      0x90
+#define EE_RESERVED     0x95
+#define EE_CONFIG_A     0xa0
+#define EE_CONFIG_B     0xa8
+#define EE_CHECKPOINT_A 0xb0
+#define EE_CHECKPOINT_B 0xc0
+#define EE_LOG          0xd0
+#define EE_IMAGE_MAGIC  0xa5
+
+#define CONFIG_VERSION  1 // 配置记录的格式 改变格式时加 1 (旧版本的记录视为无效)
+
+#define EEPROM_IMAGE_LOADER // 开机时镜像标记不同 则写入 eeprom_image.c 中的镜像
+
+// ------- define for music ----------
+
+#define MUSIC_BUF_SIZE 8 // 音乐双缓冲 每块字节数
+
+/**
+ * 24c02 中的乐谱为每个音符一字节: 高2位 时值等级 低6位 音符索引(0-36)
+ *   时值 = 1 << 时值等级 即 1 2 4 8 拍
+ *   NOTE_DOT: 前缀 下一个音符为附点音符 时值 * 1.5 (3 6 12 拍)
+ *   NOTE_RUN: 低6位为 0x3f 时 高2位 n 表示上一个音符再重复 n+1 次
+ */
+#define NOTE_DOT 0x3e
+#define NOTE_RUN 0x3f
+
 #endif // __CONFIG___H
\ No newline at end of file
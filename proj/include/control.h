@@ -0,0 +1,56 @@
+/**
+ * control.h
+ * 日期：2026/10/19
+ * ----------------------------------------------
+ * - 温度控制: 由温度和上下限决定 上/下越界 (继电器) 和风扇占空比
+ * - 与 C51 无关的通用 C 代码 也可以在主机上编译 (tools/thermsim)
+ * - 上下限各有回差: 越界后要回到 限值 -/+ 回差 才解除 避免继电器在限值附近抖动
+ * - 风扇两种方式:
+ *   CTRL_PROP 比例: 刚越界 FAN_DUTY_MIN 超过 2 * 档位步长 度时全速
+ *   CTRL_PI   定点 PI: 以上限为目标 积分只在输出未饱和时累加 (抗积分饱和)
+ * - 参数保存在 24c02 EE_CONTROL 开机读取 无效时使用默认值
+ */
+#ifndef CONTROL_H
+#define CONTROL_H
+
+#ifndef __C51__ // 在主机上编译
+#define bit unsigned char
+#define code
+#endif
+#ifndef CTRL_STATE
+#define CTRL_STATE // 控制引擎的状态变量 主机多线程仿真时定义为 thread_local
+#endif
+
+#define FAN_PWM_LEVELS 64 // 风扇 PWM 级数 (2 的幂) 也是占空比的最大值
+#define FAN_DUTY_MIN   26 // 风扇工作时的最小占空比 (约 40% 与原来的 1 档相同)
+
+// 风扇控制方式
+#define CTRL_PROP 0 // 比例
+#define CTRL_PI   1 // 比例积分
+
+// ctrlParam 的下标 (与 24c02 EE_CONTROL 开始的字节顺序相同)
+#define CTRL_MODE      0 // 风扇控制方式
+#define CTRL_HYST_HIGH 1 // 上限回差 单位 1/16 度
+#define CTRL_HYST_LOW  2 // 下限回差 单位 1/16 度
+#define CTRL_KP        3 // 比例系数 每超过 1 度 增加 Kp 级占空比
+#define CTRL_KI        4 // 积分系数 每个采样 每超过 1 度 增加 Ki/16 级占空比
+#define CTRL_PARAM_NUM 5
+
+#define CTRL_HYST_MAX 80 // 回差最大 5 度
+#define CTRL_GAIN_MAX 64 // Kp Ki 的最大值 (Kp 为 64 时超过 1 度就全速)
+
+extern CTRL_STATE unsigned char ctrlParam[CTRL_PARAM_NUM];
+
+// 输出
+extern CTRL_STATE unsigned char ctrlDuty; // 风扇占空比 0 - FAN_PWM_LEVELS
+extern CTRL_STATE bit ctrl_above;         // 高于上限 (含回差)
+extern CTRL_STATE bit ctrl_below;         // 低于下限 (含回差)
+extern CTRL_STATE bit ctrl_raw_above;     // 高于上限 (不含回差 越界计时只在此时计时)
+extern CTRL_STATE bit ctrl_raw_below;     // 低于下限 (不含回差)
+
+extern void Control_Check  (void); // 有参数超出范围 (如 24c02 为擦除状态) 时全部使用默认值
+extern void Control_Reset  (void); // 清除状态 (越界 积分)
+extern void Control_Update (int temp, char upper, char lower, unsigned char step);
+// temp: 单位 1/16 度  upper lower: 上下限 度  step: 风扇档位步长 度 (CTRL_PROP)
+
+#endif // CONTROL_H
@@ -0,0 +1,71 @@
+/**
+ * diag.h
+ * 日期：2026/10/19
+ * ----------------------------------------------
+ * 运行时诊断 在 __config__.h 中定义 DIAG_ENABLE 才编译 否则没有任何代码和变量
+ * - 中断: 每个中断源的 响应延迟最大值 执行时间最小/最大值 次数 (机器周期)
+ *   T0 方式2 从 0 开始计数 进入中断时的 TL0 即溢出后经过的机器周期 (含压栈)
+ *   T2 进入中断时的 TL2 - RCAP2L 为延迟 T0 T2 都以进出时计数值之差为执行时间
+ *   (T2 用于发声 不能改为捕获方式 T1 用于串口波特率 所以不另用一个自由计数的定时器)
+ *   串口为低优先级 以 TL0 计时 被 T0 T2 打断的那一次只计次数
+ *   X0 的按键消抖约 1s 以 T0 节拍计 (设置模式中 T0 停止)
+ * - 主循环: 视图模式中一次循环的最长时间 (T0 节拍)
+ * - CPU: 每 256 个节拍 T0 T2 中断执行的机器周期占的比例 (其余时间都在主循环)
+ * - 栈: 开机时把栈以上的 idata 填为 STACK_PAINT 之后查询被改写过的最高地址
+ *   最深处为 设置模式的按键调用链 (KeysSystem_2 -> ... -> Delay1ms)
+ *   加上 X0 以及打断它的 T0 或 T2 (各有返回地址和压栈的 ACC B DPTR PSW)
+ * - 记录以宏的形式写在各个中断函数中 (不同优先级的中断不能调用同一个不可重入的函数)
+ *   T0 每次约多 40 个机器周期 只在调试时打开
+ * - 诊断视图: 在设置查询视图再按一次 S4 之后每按一次 S4 切换下一项
+ */
+#ifndef DIAG_H
+#define DIAG_H
+
+#ifdef DIAG_ENABLE
+
+// 中断源 (统计的下标) 与诊断视图的各项
+#define DIAG_T0       0
+#define DIAG_T2       1
+#define DIAG_UART     2
+#define DIAG_SRC_NUM  3 // 记录执行时间的中断
+#define DIAG_X0       3
+#define DIAG_LOOP     4
+#define DIAG_STACK    5
+#define DIAG_VIEW_NUM 6
+
+extern unsigned char diagLatMax[];          // 响应延迟的最大值
+extern unsigned char diagExMin[], diagExMax[]; // 执行时间的最小/最大值 255: 超过一个周期
+extern unsigned int  diagCount[];           // 次数 (T0 T2 串口 X0)
+extern unsigned int  diagX0Max;             // X0 最长的时间 (节拍)
+extern unsigned int  diagLoopMax;           // 主循环一次最长的时间 (节拍)
+extern unsigned int  diagBusy;              // 本窗口中 T0 T2 执行的机器周期
+extern unsigned char diagLoad;              // 上一个窗口 (256 个节拍) 的 CPU 占用 256 为 100%
+extern unsigned char diagView;              // 诊断视图显示的项
+extern unsigned char diagStackBase;         // 开机时的 SP (栈从下一个字节开始)
+
+extern void Diag_Loop(void); // 视图模式每次主循环调用一次
+extern void Diag_StackPaint(void);          // main 的第一条语句 (之前没有压栈)
+extern unsigned char Diag_StackPeak(void);  // 栈用到的最高地址
+
+// 在中断的最后记录一次 EX 需为变量 (宏中使用多次)
+#define DIAG_EXEC(N, EX)           \
+    do                             \
+    {                              \
+        if ((EX) < diagExMin[N])   \
+            diagExMin[N] = (EX);   \
+        if ((EX) > diagExMax[N])   \
+            diagExMax[N] = (EX);   \
+        ++diagCount[N];            \
+    } while (0)
+
+#define DIAG_ISR(N, LAT, EX)       \
+    do                             \
+    {                              \
+        if ((LAT) > diagLatMax[N]) \
+            diagLatMax[N] = (LAT); \
+        DIAG_EXEC(N, EX);          \
+    } while (0)
+
+#endif // DIAG_ENABLE
+
+#endif // DIAG_H
@@ -30,7 +30,7 @@ extern void DS18B20_Get(
     unsigned char* lowerLimit,
     unsigned char* resolution
 );
-extern void DS18B20_Save(void);
+extern void DS18B20_Save(void); // 复制暂存器到 DS18B20 的 EEPROM (配置已改存 24c02 不再调用)
 
 // extern void DS18B20_Update(void);
 
@@ -17,11 +17,16 @@
 // -------------------------------------
 
 // 定义LCD1602基本操作函数
-extern void          LCD1602_CheckBusy (void);              // 检查忙标志位 含命令9 (不需要作为对外的接口)
+extern bit           LCD1602_CheckBusy (void);              // 等待忙标志位 含命令9 超时返回 0 (不需要作为对外的接口)
 extern void          LCD1602_WriteCmd  (unsigned char cmd); // 写入命令 命令1-8
 extern void          LCD1602_WriteData (unsigned char dat); // 写入数据 命令10
 extern unsigned char LCD1602_ReadData  (void);              // 读数据 命令11
 // 读数据用的很少，定义宏 LCD1602_NO_READDATA 可以不编译 LCD1602_ReadData(void)
+// 等待忙标志位的最多查询次数 可以定义宏 LCD1602_BUSY_LIMIT 修改 (默认 250)
+
+// 不等待的操作 供中断驱动的写入队列使用 (不要与上面的函数混用在同一时段)
+extern bit           LCD1602_Busy      (void);                      // 查询一次忙标志位 1: 忙
+extern void          LCD1602_Send      (bit rs, unsigned char byte); // 直接写入 rs 0: 命令 1: 数据
 
 // ------------- 命令封装 --------------
 
@@ -59,8 +64,8 @@ extern unsigned char LCD1602_ReadData  (void);              // 读数据 命令1
 #define Set_8bit_2line_5x7   0x38 // 0x38-0x3b
 #define Set_8bit_2line_5x10  0x3c // 0x3c-0x3f
 
-// 命令7：设置字库地址 0x40-0x5f
-#define Move_CGROM_ADDRESS(X) ((0x00 <= (X) && (X) <= 0x1f) ? 0x40 | (X) : 0x00)
+// 命令7：设置字库地址 0x40-0x7f (8 个自定义字符 每个 8 行)
+#define Move_CGROM_ADDRESS(X) ((0x00 <= (X) && (X) <= 0x3f) ? 0x40 | (X) : 0x00)
 
 // 命令8：设置光标位置 0x80-0xa7 0xc0-0xe7
 
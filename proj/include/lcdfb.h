@@ -0,0 +1,35 @@
+/**
+ * lcdfb.h
+ * 日期：2026/10/19
+ * ----------------------------------------------
+ * - LCD1602 的影子显存 (2行 * 16列) 视图模式的页面先写入影子显存
+ * - LcdFb_Flush 只把内容改变了的单元写入 LCD1602
+ * - 连续改变的单元只需要一次光标定位 没有改变时不访问 LCD1602
+ * - 改变的内容放入写入队列 由 T0 中断每个节拍写入一个字节 主循环不等待忙标志
+ * - LCD1602 连续 10ms 忙 (损坏或未连接) 中断丢弃队列 恢复后整屏重新写入
+ * - 自定义字符: LcdFb_Glyph 指定 CGRAM 某个位置的字形 返回显示它的字符
+ *   记录每个位置的字形 只有改变时才重新写入 CGRAM
+ * - 光标定位使用与 lcd1602.h 相同的 Move_Cursor_Row1_Col(X) 等命令值
+ */
+#ifndef LCDFB_H
+#define LCDFB_H
+
+extern void LcdFb_Clear      (void);              // 清空为空格 (只刷新原来不是空格的单元)
+extern void LcdFb_Reset      (void);              // LCD1602 已清屏 影子显存清空且不需要刷新
+extern void LcdFb_Invalidate (void);              // LCD1602 内容未知 下次全部刷新 (T0 不工作时调用)
+extern void LcdFb_Cursor     (unsigned char cmd); // 定位 命令8 0x80-0x8f 0xc0-0xcf
+extern void LcdFb_WriteData  (unsigned char dat); // 写入一个字符 超出屏幕的忽略
+extern void LcdFb_ShowString (unsigned char* s);  // 写入字符串
+extern void LcdFb_Flush      (void);              // 将改变的单元放入写入队列
+extern bit  LcdFb_FlushLimit (unsigned char n);   // 最多放入 n 个单元 返回 1: 还有单元没有放入
+extern bit  LcdFb_Push       (bit rs, unsigned char byte); // 直接放入一个命令(0)/数据(1) 队列已满返回 0
+extern void LcdFb_Service    (void);              // T0 中断中调用 写入队列中的一个字节
+
+// CGRAM 位置 slot (0-7) 放入字形 id 返回显示它的字符 0x08-0x0f
+extern unsigned char LcdFb_Glyph (unsigned char slot, unsigned char id);
+
+// 字形编号 (lcdfb.c 中 LcdGlyph 的下标)
+#define GLYPH_NONE   0xff
+#define GLYPH_BAR(N) ((N) - 1) // 底部 N 行点亮的柱 N: 1-7 (8 行用 0xff 全黑字符)
+
+#endif // LCDFB_H
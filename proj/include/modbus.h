@@ -0,0 +1,33 @@
+/**
+ * modbus.h
+ * 日期：2026/10/19
+ * ----------------------------------------------
+ * - Modbus RTU 从机 使用 uart.h 设置的串口 (与遥测二选一 定义 UART_MODBUS)
+ * - 串口中断接收字节 T0 节拍计算 3.5 个字符的静默 静默后整帧交给主循环处理
+ * - 主循环处理请求 应答由串口中断逐个字节发送 处理和发送期间不接收
+ * - 读取温度时关中断约 6.7ms (写入了设置时约 11ms) 与之重叠的请求不应答 主机应在超时后重发
+ * - 寄存器 (每个 16 位 高字节在前):
+ *   输入寄存器 (功能码 04)
+ *     0 温度 1 最高温 2 最低温 (单位 1/16 度 有符号)
+ *     3 高于上限的时间 4 低于下限的时间 (秒)
+ *     5 风扇档位 6 风扇占空比 (0-64) 7 状态 (位0 高于上限 位1 低于下限 位2 风扇工作)
+ *   保持寄存器 (功能码 03 读 06 10 写)
+ *     0 温度上限 1 温度下限 (有符号 度) 2 分辨率 3 风扇档位步长 4 铃声序号 5 铃声速率
+ *     写入与按键修改设置相同: 检查范围 写入 DS18B20 暂存器 提交 24c02 配置记录
+ *   功能码 0x41 (用户定义) 读 24c02 的一页
+ *     请求: 地址 0x41 页号(0-15) CRC  应答: 地址 0x41 页号 16 字节 CRC
+ *     日志在 EE_LOG 开始的页 (13-15)
+ */
+#ifndef MODBUS_H
+#define MODBUS_H
+
+extern void Modbus_Process (void); // 主循环中 modbus_frame 置位时调用
+extern void Modbus_Service (void); // 串口中断中调用
+extern void Modbus_Overrun (void); // 关中断期间收到字节 (可能丢失) 时丢弃正在接收的帧
+
+extern unsigned int Crc16(unsigned char* dat, unsigned char num); // Modbus CRC-16 低字节先发送
+
+extern unsigned char mbSilence; // T0 每个节拍减 1 减到 0 时置位 modbus_frame
+extern bit modbus_frame;
+
+#endif // MODBUS_H
@@ -0,0 +1,100 @@
+/**
+ * trace.h
+ * 日期：2026/10/19
+ * ----------------------------------------------
+ * 事件追踪 在 __config__.h 中定义 TRACE_ENABLE 才编译 否则以下的宏都为空
+ * - idata 中的环形缓冲 只保留最近的 TRACE_SIZE 条记录
+ * - 每条记录 4 字节: 节拍高 节拍低 事件 参数 (中断的进出 参数为 TL0 即节拍内的机器周期)
+ * - 进入设置模式时 (长按 X0) 冻结缓冲 以遥测帧 TM_TRACE 发送 发送完后清空继续记录
+ *   主机端 tools/trace2json 转为 Chrome 的 Trace Event 格式 (chrome://tracing Perfetto)
+ * - TRACE_RAW: 不会被打断时使用 (高优先级的 T2 中断 或已关中断) 约 20 个机器周期
+ *   TRACE:     主循环 T0 (发声时为低优先级 会被 T2 打断) X0 串口中断 (关中断写入)
+ */
+#ifndef TRACE_H
+#define TRACE_H
+
+// 事件
+#define TR_T0_IN         0x01 // 中断的进出 参数: TL0
+#define TR_T0_OUT        0x02
+#define TR_T2_IN         0x03
+#define TR_T2_OUT        0x04
+#define TR_UART_IN       0x05
+#define TR_UART_OUT      0x06
+#define TR_X0_IN         0x07
+#define TR_X0_OUT        0x08
+#define TR_SENSOR_IN     0x10 // 开始读取温度 (关中断 节拍停止)
+#define TR_SENSOR_OUT    0x11 // 读取完成并开始下一次转换 参数: 整数温度
+#define TR_LCD_FLUSH     0x12 // 影子显存有改变 放入写入队列
+#define TR_EE_CONFIG     0x13 // 提交配置记录
+#define TR_EE_CHECKPOINT 0x14 // 写入检查点 参数: 序号
+#define TR_MODE          0x15 // 参数: 1 进入设置模式 0 回到视图模式
+#define TR_RELAY         0x16 // 继电器 参数: 1 闭合 0 断开
+#define TR_NOTE          0x17 // 开始一个音符 参数: 音符索引
+#define TR_NOTE_STALL    0x18 // 音乐缓冲还未读取 音符推迟一个节拍
+
+#ifdef TRACE_ENABLE
+
+#define TRACE_MASK (TRACE_SIZE * 4 - 1)
+
+extern unsigned char idata traceBuf[];
+extern unsigned char traceHead; // 下一条记录的位置
+extern bit trace_hold;          // 正在发送 不记录
+extern bit trace_wrapped;       // 缓冲已写满一圈
+extern unsigned int tickCount;
+
+extern void Trace_Dump    (void); // 冻结缓冲并开始发送
+extern void Trace_Service (void); // 主循环中调用 发送缓冲区有空间时发送下一帧
+
+#define TRACE_RAW(ID, ARG)                                     \
+    do                                                         \
+    {                                                          \
+        if (!trace_hold)                                       \
+        {                                                      \
+            unsigned char idata* p_ = traceBuf + traceHead;    \
+            p_[0] = (unsigned char)(tickCount >> 8);           \
+            p_[1] = (unsigned char)tickCount;                  \
+            p_[2] = (ID);                                      \
+            p_[3] = (ARG);                                     \
+            if (!(traceHead = (traceHead + 4) & TRACE_MASK))   \
+                trace_wrapped = 1;                             \
+        }                                                      \
+    } while (0)
+
+#define TRACE(ID, ARG)        \
+    do                        \
+    {                         \
+        EA = 0;               \
+        TRACE_RAW(ID, ARG);   \
+        EA = 1;               \
+    } while (0)
+
+#else
+
+#define TRACE_RAW(ID, ARG)
+#define TRACE(ID, ARG)
+
+#endif // TRACE_ENABLE
+
+// 中断的进出 由 TRACE_ISR 选择 (T0 T2 每秒几千次 打开后缓冲只能保留几毫秒)
+#if defined(TRACE_ENABLE) && (TRACE_ISR & 0x01)
+#define TRACE_T0(ID) TRACE(ID, TL0)
+#else
+#define TRACE_T0(ID)
+#endif
+#if defined(TRACE_ENABLE) && (TRACE_ISR & 0x02)
+#define TRACE_T2(ID) TRACE_RAW(ID, TL0)
+#else
+#define TRACE_T2(ID)
+#endif
+#if defined(TRACE_ENABLE) && (TRACE_ISR & 0x04)
+#define TRACE_UART(ID) TRACE(ID, TL0)
+#else
+#define TRACE_UART(ID)
+#endif
+#if defined(TRACE_ENABLE) && (TRACE_ISR & 0x08)
+#define TRACE_X0(ID) TRACE(ID, TL0)
+#else
+#define TRACE_X0(ID)
+#endif
+
+#endif // TRACE_H
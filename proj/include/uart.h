@@ -0,0 +1,22 @@
+/**
+ * uart.h
+ * 日期：2026/10/19
+ * ----------------------------------------------
+ * - 片上串口 方式1 (8 位数据 1 位停止) 波特率由 T1 方式2 产生 (T0 节拍 T2 发声)
+ * - 发送环形缓冲: 主循环放入整帧 串口中断每次发送一个字节 主循环不等待
+ * - 帧格式: COBS(数据 + CRC-8) + 0x00 分隔符 CRC 与 utility.h 中 Crc8 相同
+ *   接收方以 0x00 切分 解码后最后一个字节为 CRC 数据中可以有 0x00
+ * - 串口中断为低优先级 不会推迟 T0 的节拍
+ * - 在 __config__.h 中定义 UART_TELEMETRY 才编译 (Uart_Init 也用于 UART_MODBUS)
+ */
+#ifndef UART_H
+#define UART_H
+
+extern void Uart_Init      (void); // 设置 T1 和串口 (在 init_data 中调用)
+extern bit  Uart_SendFrame (unsigned char* dat, unsigned char num); // 缓冲区不够时丢弃并返回 0
+extern void Uart_Service   (void); // 串口中断中调用
+extern unsigned char Uart_TxFree (void); // 发送缓冲的空闲字节数 (一帧需要 数据 + 3)
+
+extern unsigned char uartDrops; // 因缓冲区不够丢弃的帧数 (到 255 为止)
+
+#endif // UART_H
@@ -11,12 +11,21 @@
 extern void Delay1ms(unsigned int t);
 
 extern void LCD1602_ShowString(unsigned char* s); // 显示字符串
-extern void LCD1602_Action(void); // 开机 并显示开机画面
+extern void LCD1602_Action(void); // 开机 初始化 LCD1602 (T0 工作前)
 
+extern unsigned int GetTickCount(void); // 读取全局节拍 (1/3.6ms)
+extern void BootSplash(void); // 开机动画的下一步 (在主循环中调用)
+
+extern void ShowTemperature(void); // 当前温度 (5 个字符)
 extern void ShowViewPage_1(void); // 主视图 (温度信息查询视图)
 extern void ShowViewPage_2(void); // 最高/最低温(温度极值)查询视图
 extern void ShowViewPage_3(void); // 温度越界计时视图
 extern void ShowViewPage_4(void); // 设置查询视图
+extern void ShowViewPage_5(void); // 温度历史曲线视图
+#ifdef DIAG_ENABLE
+extern void ShowViewPage_6(void); // 诊断视图
+extern void UpdateDiag(void);     // 更新诊断视图显示
+#endif
 extern void ShowSettings(unsigned char opt); // 设置模式显示
 
 extern void KeysSystem_1(void);
@@ -28,16 +37,44 @@ extern void BelowLimitClock(void); // 下越界计时
 extern void UpdateOverLimitTimer(bit which); // 更新越界的定时值
 extern void UpdateExtremes(bit which); // 更新最高/最低温度值(极值)
 
-extern void ReadMusic(void); // 读取音乐
+extern void InitHistory(void);   // 清空温度历史
+extern void AddHistory(void);    // 记录一个温度历史采样
+extern void UpdateHistory(void); // 更新温度历史曲线显示
+
+extern void ReadMusic(void);   // 读取音乐 (起止地址 并预读缓冲)
+extern void RefillMusic(void); // 在主循环中读取下一块音乐
+
+extern void LoadConfig(void);   // 读取配置记录 (没有时由旧的设置转换)
+extern void CommitConfig(void); // 提交配置记录 只写入内容改变了的槽
+
+extern void SaveCheckpoint(void);    // 写入极值与越界计时的检查点
+extern void RestoreCheckpoint(void); // 开机时从较新的有效检查点恢复
+
+extern void LoadEepromImage(void); // 24c02 镜像标记不同时写入初始镜像
+
+extern void Telemetry_Sample(void);            // 发送一个采样帧 (每 TELEMETRY_EVERY 次调用)
+extern void Telemetry_Event(unsigned char ev); // 立即发送一个事件帧
+
+// 遥测帧类型 (帧的第一个字节)
+#define TM_SAMPLE 0x01
+#define TM_EVENT  0x02
+#define TM_TRACE  0x03 // 追踪缓冲 (trace.h)
+// 事件
+#define TM_EV_BOOT     0x00 // 开机
+#define TM_EV_ABOVE    0x01 // 高于上限
+#define TM_EV_BELOW    0x02 // 低于下限
+#define TM_EV_NORMAL   0x03 // 回到上下限之间
+#define TM_EV_SETTINGS 0x04 // 进入设置模式
+#define TM_EV_VIEW     0x05 // 退出设置模式
 
 #endif // ULTIMATE_H
 /**
  * 三套按键系统
  * 第一套: 视图模式下 全部上升沿(松开按键时)触发
  *   S1: 主视图 (温度信息查询视图)
- *   S2: 最高/最低温(温度极值)查询视图
+ *   S2: 最高/最低温(温度极值)查询视图 在此视图再按一次: 温度历史曲线视图
  *   S3: 温度越界计时视图
- *   S4: 设置查询视图
+ *   S4: 设置查询视图 在此视图再按一次: 诊断视图 (DIAG_ENABLE) 之后每按一次切换下一项
  *
  * 第二套: 设置模式下 全部上升沿(松开按键时)触发
  *   S1: 修改当前选项值
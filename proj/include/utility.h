@@ -10,8 +10,15 @@
 
 extern void Int8ToString(char num, unsigned char* str, unsigned char length);
 
-extern void FloatToString(
-    float num, unsigned char* str, unsigned char length, unsigned char decimal
-);
+#ifdef DIAG_ENABLE
+// 无符号数 右对齐 长度不够时只保留低位 (只用于诊断视图)
+extern void UIntToString(unsigned int num, unsigned char* str, unsigned char length);
+#endif
+
+// num 单位 1/16 (DS18B20 原始温度值) 保留 1 位小数
+extern void Temp16ToString(int num, unsigned char* str, unsigned char length);
+
+// CRC-8/MAXIM (与 DS18B20 相同) 用于校验 24c02 中的记录
+extern unsigned char Crc8(unsigned char* dat, unsigned char num);
 
 #endif
\ No newline at end of file
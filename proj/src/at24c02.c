@@ -7,8 +7,6 @@
  */
 #include "i2c.h"
 
-#define AT24C02_NO_MULTI_PAGE_WRITE
-
 #ifndef uchar
 #define uchar unsigned char
 #endif
@@ -105,39 +103,19 @@ bit At24c02_Check(uchar sla) // 检查是否写入完成
 // 连续页写入 带延迟(确保写入完成)
 bit At24c02_WriteData(uchar sla, uchar suba, uchar* dat, uchar num)
 {
-    uchar begin, end, i;
-    if (!num)
-        return 1;
-    begin = suba >> PAGE_BIT;
-    end = (suba + (num - 1)) >> PAGE_BIT;
-    if (begin != end)
+    uchar i;
+    while (num)
     {
-        i = PAGE_END - (suba & PAGE_END) + 1;
-        At24c02_WriteByte(sla, suba, dat, i);
+        i = PAGE_BYTE - (suba & PAGE_END); // 当前页剩余的字节数 不能跨页写入
+        if (i > num)
+            i = num;
+        if (!At24c02_WriteByte(sla, suba, dat, i) || !At24c02_Check(sla))
+            return 0;
         suba += i;
         dat += i;
-        ++begin;
-        if (!At24c02_Check(sla))
-            return 0;
-    }
-    while ((begin != end) && begin < PAGE_END)
-    {
-        At24c02_WriteByte(sla, suba, dat, PAGE_BYTE);
-        suba += PAGE_BYTE;
-        dat += PAGE_BYTE;
-        ++begin;
-        if (!At24c02_Check(sla))
-            return 0;
+        num -= i;
     }
-    if (At24c02_WriteByte(
-            sla,
-            suba,
-            dat,
-            ((begin == end) ? ((num - i) & PAGE_END) : (PAGE_END))
-        ))
-        return At24c02_Check(sla);
-    else
-        return 0;
+    return 1;
 }
 
 #endif
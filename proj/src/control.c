@@ -0,0 +1,126 @@
+/**
+ * control.c
+ * 日期：2026/10/19
+ * ----------------------------------------------
+ * 每次温度转换完成调用一次 Control_Update (即采样周期 与分辨率有关)
+ * 只用整数运算 积分为 Q8 定点数 (单位 1/256 级占空比)
+ */
+#include "control.h"
+
+#define uint unsigned int
+#define uchar unsigned char
+
+#define INTEG_MAX ((long)FAN_PWM_LEVELS << 8)
+
+uchar code CtrlDefault[CTRL_PARAM_NUM] = {
+    CTRL_PROP, // 比例 (与原来的档位相同)
+    16,        // 上限回差 1 度
+    16,        // 下限回差 1 度
+    16,        // Kp 每度 16 级 (25%)
+    4          // Ki 每个采样 每度 0.25 级
+};
+
+// 每个参数的最大值 (最小值都为 0) 24c02 中的记录没有 CRC 任何一个超出都视为无效
+uchar code CtrlMax[CTRL_PARAM_NUM] = {
+    CTRL_PI,       // 方式
+    CTRL_HYST_MAX, // 上限回差
+    CTRL_HYST_MAX, // 下限回差
+    CTRL_GAIN_MAX, // Kp
+    CTRL_GAIN_MAX  // Ki
+};
+
+CTRL_STATE uchar ctrlParam[CTRL_PARAM_NUM];
+
+CTRL_STATE uchar ctrlDuty = 0;
+CTRL_STATE bit ctrl_above = 0;
+CTRL_STATE bit ctrl_below = 0;
+CTRL_STATE bit ctrl_raw_above = 0;
+CTRL_STATE bit ctrl_raw_below = 0;
+
+CTRL_STATE long ctrlInteg = 0; // 积分 Q8
+
+void Control_Check(void)
+{
+    uchar i;
+    for (i = 0; i < CTRL_PARAM_NUM; ++i)
+        if (ctrlParam[i] > CtrlMax[i])
+            break;
+    if (i == CTRL_PARAM_NUM)
+        return;
+    for (i = 0; i < CTRL_PARAM_NUM; ++i)
+        ctrlParam[i] = CtrlDefault[i];
+}
+
+void Control_Reset(void)
+{
+    ctrlDuty = 0;
+    ctrl_above = 0;
+    ctrl_below = 0;
+    ctrl_raw_above = 0;
+    ctrl_raw_below = 0;
+    ctrlInteg = 0;
+}
+
+// 比例: FAN_DUTY_MIN 到 2 * step 度时全速 步长为 0 直接全速
+uchar FanProp(int err, uchar step)
+{
+    uint span = (uint)step << 5; // 2 * step 度 (单位 1/16 度)
+    if (err < 0)
+        return FAN_DUTY_MIN; // 在回差范围内 保持最低速
+    if ((uint)err >= span)
+        return FAN_PWM_LEVELS;
+    return FAN_DUTY_MIN + (uint)err * (FAN_PWM_LEVELS - FAN_DUTY_MIN) / span;
+}
+
+// 比例积分: 输出饱和且误差使其更饱和时不累加积分
+uchar FanPI(int err)
+{
+    long out;
+    long inc = (long)ctrlParam[CTRL_KI] * err; // Q8: Ki/16 * err/16 * 256
+    out = (((long)ctrlParam[CTRL_KP] * err) >> 4) + ((ctrlInteg + inc) >> 8);
+    if (!((out >= FAN_PWM_LEVELS && inc > 0) || (out <= FAN_DUTY_MIN && inc < 0)))
+    {
+        ctrlInteg += inc;
+        if (ctrlInteg > INTEG_MAX)
+            ctrlInteg = INTEG_MAX;
+        else if (ctrlInteg < 0)
+            ctrlInteg = 0;
+    }
+    out = (((long)ctrlParam[CTRL_KP] * err) >> 4) + (ctrlInteg >> 8);
+    if (out >= FAN_PWM_LEVELS)
+        return FAN_PWM_LEVELS;
+    if (out <= FAN_DUTY_MIN)
+        return FAN_DUTY_MIN; // 风扇工作时不低于最小占空比 (低于可能转不起来)
+    return (uchar)out;
+}
+
+void Control_Update(int temp, char upper, char lower, uchar step)
+{
+    int high = (int)upper << 4;
+    int low = (int)lower << 4;
+    // 不含回差的越界 (越界计时用)
+    ctrl_raw_above = temp > high;
+    ctrl_raw_below = !ctrl_raw_above && temp < low;
+    // 上限: 高于上限越界 回到 上限 - 回差 以下才解除
+    if (temp > high)
+        ctrl_above = 1;
+    else if (temp <= high - ctrlParam[CTRL_HYST_HIGH])
+        ctrl_above = 0;
+    // 下限: 低于下限越界 回到 下限 + 回差 以上才解除
+    if (ctrl_above)
+        ctrl_below = 0;
+    else if (temp < low)
+        ctrl_below = 1;
+    else if (temp >= low + ctrlParam[CTRL_HYST_LOW])
+        ctrl_below = 0;
+
+    if (!ctrl_above)
+    {
+        ctrlDuty = 0;
+        ctrlInteg = 0;
+    }
+    else if (ctrlParam[CTRL_MODE] == CTRL_PI)
+        ctrlDuty = FanPI(temp - high);
+    else
+        ctrlDuty = FanProp(temp - high, step);
+}
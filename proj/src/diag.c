@@ -0,0 +1,62 @@
+/**
+ * diag.c
+ * 日期：2026/10/19
+ * ----------------------------------------------
+ * 诊断的统计值 中断中以 diag.h 中的宏记录 主循环中读取多字节的值时关中断
+ */
+#include "__config__.h"
+#include "diag.h"
+#include "ultimate.h"
+
+#define uint unsigned int
+#define uchar unsigned char
+
+#ifdef DIAG_ENABLE
+
+uchar diagLatMax[DIAG_SRC_NUM] = {0, 0, 0};
+uchar diagExMin[DIAG_SRC_NUM] = {0xff, 0xff, 0xff};
+uchar diagExMax[DIAG_SRC_NUM] = {0, 0, 0};
+uint diagCount[DIAG_X0 + 1] = {0, 0, 0, 0};
+uint diagX0Max = 0;
+uint diagLoopMax = 0;
+uint diagLoopLast = 0; // 上一次主循环的节拍 (T0 从 0 开始计数)
+uint diagBusy = 0;
+uchar diagLoad = 0;
+uchar diagView = 0;
+uchar diagStackBase = 0;
+
+void Diag_Loop(void)
+{
+    uint t = GetTickCount(), d;
+    d = t - diagLoopLast;
+    diagLoopLast = t;
+    if (d > diagLoopMax)
+        diagLoopMax = d;
+}
+
+/**
+ * 从 SP 的下一个字节填充到 0xff (89C52 的 idata 共 256 字节)
+ * 调用时 SP 指向本函数的返回地址 不会改写它
+ */
+void Diag_StackPaint(void)
+{
+    uchar idata* p = (uchar idata*)SP;
+    diagStackBase = SP - 2; // 调用前的 SP
+    do
+        *++p = STACK_PAINT;
+    while (p != (uchar idata*)0xff);
+}
+
+/**
+ * 从 0xff 向下找第一个被改写的字节 (栈中恰好为 STACK_PAINT 的字节会少算)
+ * 用到的字节数: Peak - diagStackBase 余量: 0xff - Peak
+ */
+uchar Diag_StackPeak(void)
+{
+    uchar idata* p = (uchar idata*)0xff;
+    while (p != (uchar idata*)diagStackBase && *p == STACK_PAINT)
+        --p;
+    return (uchar)p;
+}
+
+#endif // DIAG_ENABLE
@@ -57,28 +57,28 @@ uchar DS18B20_InitCheck(void)
     DQ = 0;
     DS18B20_Delay10us(60); // 拉低 480~960us
     DQ = 1;
-    DS18B20_Delay10us(12); // 等待 15~60us 240us之内
+    DS18B20_Delay10us(6);  // 存在脉冲 15~60us 后开始 在释放后约 66us 采样
     x = DQ;                // 总线60~240us低电平
     DQ = 1;                // 释放总线
-    DS18B20_Delay10us(24); // 保证时序完整
+    DS18B20_Delay10us(40); // 释放后至少 480us 才能开始下一个时隙
     return x;
-} // 约 bit 973 uchar 976
+} // 约 1075
 
 uchar DS18B20_ReadByte(void)
 {
     uchar i = 8, dat = 0;
     do // 串行读8位数据，先读低位后读高位
     {
-        DQ = 0; // 拉低
-        DS18B20_Delay10us(1);
-        DQ = 1; // 15μs内拉高释放总线
+        DQ = 0; // 拉低 至少1us
+        _nop_();
+        DQ = 1; // 释放总线
         dat >>= 1;
-        if (DQ)
+        if (DQ) // 在下降沿后15us内采样 (约 8us)
             dat |= 0x80;
-        DS18B20_Delay10us(5); // 最少60us
+        DS18B20_Delay10us(6); // 时隙最少60us
     } while (--i);
     return dat;
-} // 约 560 (559) 587
+} // 约 585
 
 void DS18B20_WriteByte(uchar dat)
 {
@@ -86,13 +86,13 @@ void DS18B20_WriteByte(uchar dat)
     do // 串行写8位数据，先写低位后写高位
     {
         DQ = 0;
-        DS18B20_Delay10us(1); // 至少间隔1us 低于15us
-        DQ = dat & 0x01;      // 写"1" 在15μs内拉高
-        DS18B20_Delay10us(5); // 写"0" 拉低60μs 10+50
+        _nop_();              // 至少间隔1us 低于15us
+        DQ = dat & 0x01;      // 写"1" 在15μs内拉高 (约 6us)
+        DS18B20_Delay10us(6); // 写"0" 拉低60μs 6+60
         DQ = 1;
         dat >>= 1;
     } while (--i);
-} // 约 550 (551) 584
+} // 约 585
 
 // -------------------------------------
 
@@ -102,7 +102,7 @@ void DS18B20_Convert() // 温度转换
         return;
     DS18B20_WriteByte(0xcc);
     DS18B20_WriteByte(0x44);
-} // 约 2080 (2076) 2151
+} // 约 2255
 
 int DS18B20_ReadTemp() // 温度读取
 {
@@ -116,7 +116,7 @@ int DS18B20_ReadTemp() // 温度读取
     high = DS18B20_ReadByte();
     temp = (high << 8) | low;
     return temp;
-} // 约 3210 (3211) 3663
+} // 约 3460
 
 // -------------------------------------
 
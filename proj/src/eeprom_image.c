@@ -0,0 +1,30 @@
+/**
+ * eeprom_image.c
+ * 此文件由 tools/eepromc 根据 songs.txt 生成 请勿手动修改
+ * ----------------------------------------------
+ * 24c02 的初始镜像 开机时若 24c02 中的镜像标记与此不同 则按页写入
+ */
+#include "__config__.h"
+
+#ifdef EEPROM_IMAGE_LOADER
+
+unsigned char code eepromImage[256] = {
+    0x4e, 0xa5, 0x01, 0x08, 0x3b, 0x5e, 0x7a, 0x7a, 0x19, 0x1b, 0x18, 0x19, 0x59, 0x19, 0x18, 0x19, // 00
+    0x1b, 0x18, 0x19, 0x59, 0x19, 0x1b, 0x1d, 0x1b, 0x1d, 0x1b, 0x5d, 0x1d, 0x1b, 0x5d, 0x60, 0x5d, // 10
+    0x16, 0x18, 0x19, 0x1b, 0x18, 0x19, 0x59, 0x19, 0x18, 0x19, 0x1b, 0x18, 0x19, 0x59, 0x19, 0x18, // 20
+    0x1d, 0x1b, 0x1d, 0x1b, 0x5d, 0x1d, 0x1b, 0x5d, 0x60, 0x5d, 0x60, 0x56, 0x58, 0x3e, 0x99, 0x58, // 30
+    0x99, 0x9d, 0x3e, 0xd8, 0x51, 0x3f, 0x3e, 0x96, 0x54, 0x96, 0x99, 0x3e, 0xd4, 0x91, 0x3e, 0x92, // 40
+    0x51, 0x92, 0x99, 0xd1, 0x40, 0x59, 0x7f, 0x3e, 0x98, 0x52, 0x92, 0x98, 0xd8, 0x80, 0x8d, 0x3f, // 50
+    0x94, 0x3f, 0x96, 0x3f, 0xd4, 0x92, 0x3f, 0x91, 0x3f, 0x8f, 0x3f, 0xcd, 0x94, 0x3f, 0x92, 0x3f, // 60
+    0x91, 0x3f, 0xcf, 0x94, 0x3f, 0x92, 0x3f, 0x91, 0x3f, 0xcf, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, // 70
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, // 80
+    0x00, 0x10, 0x10, 0x10, 0x04, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, // 90
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, // a0
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, // b0
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, // c0
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, // d0
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, // e0
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, // f0
+};
+
+#endif // EEPROM_IMAGE_LOADER
@@ -6,6 +6,8 @@
  * ----------------------------------------------
  * 在此添加的全局变量
  */
+#include "__config__.h"
+
 #define uint unsigned int
 #define uchar unsigned char
 
@@ -23,18 +25,34 @@ bit convert_finished = 1;  // 温度传感器完成温度转化
 bit dc_motor_working = 0;  // 直流电机需要工作
 bit above_upper_limit = 0; // 温度高于上限阈值
 bit below_lower_limit = 0; // 温度低于下限阈值
-bit ringtone_change = 0;   // 铃声发生改变 需要重新读取
-bit save_in_24c02 = 0;     // 在主函数中进行24c02数据的存储(妥协)
+bit save_in_24c02 = 0;     // 在主函数中提交配置记录(妥协)
 bit play_music = 0;
+bit music_refill = 0; // 一块音乐缓冲已播放完 需要在主循环中读取下一块
+bit boot_splash = 0;     // 开机动画还在进行 (期间主循环不刷新视图)
+bit history_sample = 0;  // 到了温度历史的采样时间
+bit history_changed = 0; // 温度历史有新的采样 需要刷新曲线
+bit checkpoint_event = 0; // 新的极值 或越界结束 尽快写入检查点
+bit checkpoint_dirty = 0; // 越界计时改变了 定期写入检查点
+bit sensor_update = 0;    // 上下限 分辨率被串口修改 下次读取温度时写入 DS18B20
 
 
 // ==================== ===== ====================
 
 // ==================== 用于计算时间戳的计数变量 ====================
 
-uint dcmCount = 0;     // 用于分割直流电机方波
+uint tickCount = 0;    // 全局节拍 T0 每次中断加 1 (约 18s 回绕)
+uint bootWait = 0;     // 开机动画下一步的节拍
+uchar bootStep = 0;    // 开机动画进行到哪一步
+uint decisionTick = 0; // T0 开始工作到第一次有效的温度控制决策的节拍数
+uchar pwmCount = 0;    // 风扇 PWM 周期内的位置
 uint convertCount = 0; // 用于计算温度传感器转化时间
 uchar changeCount = 0; // 用于计算长按 持续增加/减少 间隔
+uint historyCount = 0; // 用于计算温度历史的采样间隔
+uchar checkpointAge = 0; // 上次写入检查点后经过的温度历史采样次数 (15s)
+#ifdef UART_TELEMETRY
+uchar telemetryCount = 0; // 用于计算遥测采样间隔
+uchar telemetrySeq = 0;   // 遥测帧序号 接收方据此发现丢帧
+#endif
 
 // ==================== ==================== ====================
 
@@ -46,16 +64,21 @@ uchar option = 0xff; // 用于设置模式选择不同项
 // 视图模式 主视图  设置模式 第 1 2 _ _ 项
 char upperLimit = 127;    // 温度上限
 char lowerLimit = -55;    // 温度下限
-float temperature = 80.5; // 温度
-uchar fanGear = 0;        // 风扇档位
+int temperature = 80.5 * 16; // 温度 单位 1/16 度 (DS18B20 原始值)
+uchar fanGear = 0;        // 风扇档位 (由占空比 ctrlDuty 得到 只用于显示)
+
+// 视图模式 温度极值查询视图 单位 1/16 度
+int highest = -55 * 16; // 开机后最高温
+int lowest = 127 * 16;  // 开机后最低温
 
-// 视图模式 温度极值查询视图
-float highest = -55; // 开机后最高温
-float lowest = 127;  // 开机后最低温
+// 视图模式 温度历史曲线视图 整数摄氏度 环形存储
+char idata history[HISTORY_SIZE];
+uchar historyPos = 0; // 下一个采样的位置 (即最早的采样)
 
 // 视图模式 温度过界计时视图
 uchar hus = 0, hms = 0, hs = 0, hm = 0; // 开机后 超过温度上限 时间
 uchar lus = 0, lms = 0, ls = 0, lm = 0; // 开机后 低于温度下限 时间
+uchar checkpointSeq = 0; // 下一个检查点的序号 最低位为写入的槽 (0: A 1: B)
 
 // 设置模式 第 4 项
 uchar fanGearStep = 2; // 风扇/直流电机档位步长
@@ -80,23 +103,21 @@ uchar code DC[] = {0xdf, 0x43, 0}; // °C
 // 定义一个最大长度的字符串用作打印的空间
 uchar numStr[] = "     ";
 
-// 通过全局设置显示等待(间隔)时间
-uint SHOW_WAIT = 0;
-
 // 用于接收按键操作的变量
 uchar key = 0xf;
 uchar pressKey = 0xff;
 
-// 与at24c02进行通信需要的变量
-uchar settingsSave = 0x00;
-
 // ==================== ===== ====================
 
 // ==================== 为了播放音乐而定义 ====================
 
 uint freqDelay = 0x20, freqSize = 600;
-uchar freqH = 0xfc, freqL = 0x18, freqSelect = 0; 
-uchar idata musicArr[97]; // 存储音乐节拍索引
+uchar freqSelect = 0; // 当前缓冲块中的播放位置
+uchar notePitch = 0, noteLen = 1, noteRepeat = 0; // 正在播放的音符 时值 剩余重复次数
+bit note_dotted = 0; // 读到附点前缀 下一个音符时值 * 1.5
+uchar musicSel = 0;   // 正在播放的缓冲块
+uchar musicBegin = 0, musicEnd = 0, musicAddr = 0; // 铃声在24c02中的起止 读取地址
+uchar idata musicBuf[2][MUSIC_BUF_SIZE]; // 双缓冲 播放一块的同时读取另一块
 
 uint code FreqTable[] = { // 索引与频率对照表
     0,     // 0
@@ -25,8 +25,13 @@ sbit SCL = I2C_DEFINE_SCL;
 
 extern void _nop_(void);
 
-void I2C_Wait(void) // 4us
+/**
+ * lcall + nop + ret 5 个机器周期 (约 5.4us)
+ * 空函数时 Keil 把 "SCL = 1; I2C_Wait(); SCL = 0;" 的调用优化掉 SCL 高电平只有 3 个机器周期 (tHIGH >= 4us)
+ */
+void I2C_Wait(void)
 {
+    _nop_();
 }
 
 bit I2C_CheckAck(void)
@@ -37,9 +37,14 @@ sbit EN = LCD1602_DEFINE_EN; // 使能
 
 // -------------------------------------
 
-void LCD1602_CheckBusy(void)
+#ifndef LCD1602_BUSY_LIMIT
+#define LCD1602_BUSY_LIMIT 250 // 忙标志最多查询次数 (约 2.5ms 大于清屏的 1.52ms)
+#endif
+
+bit LCD1602_CheckBusy(void)
 {
     unsigned char busy;
+    unsigned char n = LCD1602_BUSY_LIMIT;
     DT = 0xff;
     do
     {
@@ -49,8 +54,9 @@ void LCD1602_CheckBusy(void)
         RW = 1;
         EN = 1;
         busy = DT;
-    } while (busy & 0x80);
+    } while ((busy & 0x80) && --n); // 屏幕损坏或未连接时 DT 一直为高 不能无限等待
     EN = 0;
+    return !(busy & 0x80);
 }
 
 void LCD1602_WriteByte(bit rs, unsigned char byte);
@@ -88,7 +94,38 @@ extern void _nop_(void);
 
 void LCD1602_WriteByte(bit rs, unsigned char byte)
 {
-    LCD1602_CheckBusy();
+    if (!LCD1602_CheckBusy())
+        return; // 超时 放弃这一个字节
+    RW = 0;
+    RS = rs; // 0 写命令  1 写数据
+    DT = byte;
+    EN = 1; // EN: 0 -> 1
+    _nop_();
+    EN = 0;
+}
+
+// -------------------------------------
+/**
+ * 以下两个函数不等待 供定时器中断驱动的写入队列使用
+ * 先用 LCD1602_Busy 查询一次 不忙再 LCD1602_Send
+ * (与上面的函数分开 中断与主循环不会调用同一个函数)
+ */
+
+bit LCD1602_Busy(void)
+{
+    bit busy;
+    DT = 0xff;
+    EN = 0;
+    RS = 0;
+    RW = 1;
+    EN = 1;
+    busy = DT & 0x80;
+    EN = 0;
+    return busy;
+}
+
+void LCD1602_Send(bit rs, unsigned char byte)
+{
     RW = 0;
     RS = rs; // 0 写命令  1 写数据
     DT = byte;
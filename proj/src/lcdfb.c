@@ -0,0 +1,268 @@
+/**
+ * lcdfb.c
+ * 日期：2026/10/19
+ * ----------------------------------------------
+ * 影子显存: lcdFb 为屏幕上应该显示的内容 lcdDirty 每个单元一位
+ * 写入的字符与原来不同才会置位 LcdFb_Flush 放入写入队列后清除
+ * 写入队列: LcdFb_Flush (主循环) 放入 LcdFb_Service (T0 中断) 取出
+ * 每个节拍 (1/3.6ms 远大于 HD44780 约 40us 的执行时间) 查询一次忙标志
+ * 不忙就写入一个字节 主循环不再等待 LCD1602
+ * 自定义字符: glyphSlot 记录 CGRAM 每个位置中的字形 字形改变才重新写入
+ */
+#include "__config__.h"
+#include "lcd1602.h"
+#include "lcdfb.h"
+#include "trace.h"
+
+#define uint unsigned int
+#define uchar unsigned char
+
+#define FB_SIZE 32    // 2行 * 16列
+#define FB_OFF  0xff  // 光标在屏幕之外
+#define Q_SIZE  8     // 写入队列长度 (2 的幂)
+#define Q_MASK  (Q_SIZE - 1)
+#define Q_TIMEOUT 36  // 连续忙 36 个节拍 (10ms) 认为 LCD1602 失去响应
+
+uchar idata lcdFb[FB_SIZE];         // 第一行 0-15 第二行 16-31
+uchar idata lcdDirty[FB_SIZE / 8];  // 需要写入 LCD1602 的单元
+uchar lcdFbPos = 0;                 // 写入位置
+bit lcdfb_dirty = 0;                // 有单元需要写入
+
+uchar idata lcdQ[Q_SIZE];           // 写入队列 命令或数据
+uchar lcdQRs = 0;                   // 每个位置一位 1: 数据 0: 命令
+uchar lcdQHead = 0, lcdQTail = 0;   // 主循环写 Head 中断写 Tail
+uchar lcdQBusy = 0;                 // 连续忙的节拍数
+bit lcd_timeout = 0;                // 中断因超时丢弃了队列
+
+uchar idata glyphSlot[8] = {          // CGRAM 中的字形编号 GLYPH_NONE: 未知
+    GLYPH_NONE, GLYPH_NONE, GLYPH_NONE, GLYPH_NONE,
+    GLYPH_NONE, GLYPH_NONE, GLYPH_NONE, GLYPH_NONE
+};
+uchar glyphPending = 0;             // 每个位置一位 需要写入 CGRAM
+uchar glyphRow = 0;                 // 正在写入的字形的行 (队列满时下次继续)
+
+// 字形 每个 8 行 每行低 5 位有效 (5x8 点阵)
+uchar code LcdGlyph[][8] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1f}, // GLYPH_BAR(1)
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1f, 0x1f}, // GLYPH_BAR(2)
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x1f, 0x1f, 0x1f}, // GLYPH_BAR(3)
+    {0x00, 0x00, 0x00, 0x00, 0x1f, 0x1f, 0x1f, 0x1f}, // GLYPH_BAR(4)
+    {0x00, 0x00, 0x00, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f}, // GLYPH_BAR(5)
+    {0x00, 0x00, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f}, // GLYPH_BAR(6)
+    {0x00, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f}, // GLYPH_BAR(7)
+};
+
+uchar code LcdQBit[Q_SIZE] = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80};
+
+void LcdFb_Clear(void)
+{
+    uchar i = FB_SIZE;
+    do
+    {
+        if (lcdFb[--i] != ' ')
+        { // 只有原来不是空格的单元需要刷新
+            lcdFb[i] = ' ';
+            lcdDirty[i >> 3] |= 1 << (i & 7);
+            lcdfb_dirty = 1;
+        }
+    } while (i);
+    lcdFbPos = 0;
+}
+
+void LcdFb_Reset(void)
+{
+    uchar i = FB_SIZE;
+    do
+    { // LCD1602 刚刚清屏 影子显存与之一致
+        lcdFb[--i] = ' ';
+    } while (i);
+    i = FB_SIZE / 8;
+    do
+    {
+        lcdDirty[--i] = 0;
+    } while (i);
+    lcdfb_dirty = glyphPending != 0;
+    lcdFbPos = 0;
+}
+
+void LcdFb_Invalidate(void)
+{
+    uchar i = FB_SIZE / 8;
+    do
+    { // LCD1602 上的内容未知 (开机 或 被设置模式改写) 全部重新写入
+        lcdDirty[--i] = 0xff;
+    } while (i);
+    // 丢弃的队列中可能有已清除 glyphPending 的字形行 全部字形重新写入
+    for (i = 0; i < 8; ++i)
+        if (glyphSlot[i] != GLYPH_NONE)
+            glyphPending |= LcdQBit[i];
+    glyphRow = 0;
+    lcdfb_dirty = 1;
+    lcdQTail = lcdQHead; // 只在 T0 不工作时调用 丢弃旧的队列
+    lcdQBusy = 0;
+    lcd_timeout = 0;
+}
+
+uchar LcdFb_Glyph(uchar slot, uchar id)
+{
+    if (glyphSlot[slot] != id)
+    {
+        glyphSlot[slot] = id;
+        if (!(glyphPending & LcdQBit[slot]))
+        {
+            glyphPending |= LcdQBit[slot];
+            glyphRow = 0; // 如果这个位置正在写入 从头开始
+        }
+        lcdfb_dirty = 1;
+    }
+    return 0x08 | slot; // 0x08-0x0f 与 0x00-0x07 相同 且不是字符串结束符
+}
+
+void LcdFb_Cursor(uchar cmd)
+{
+    if ((cmd & 0x3f) >= 16)
+        lcdFbPos = FB_OFF;
+    else
+        lcdFbPos = ((cmd & 0x40) >> 2) | (cmd & 0x0f);
+}
+
+void LcdFb_WriteData(uchar dat)
+{
+    uchar i = lcdFbPos;
+    if (i == FB_OFF)
+        return;
+    if (lcdFb[i] != dat)
+    {
+        lcdFb[i] = dat;
+        lcdDirty[i >> 3] |= 1 << (i & 7);
+        lcdfb_dirty = 1;
+    }
+    // 与 LCD1602 一样 写到行尾后继续写入的内容在屏幕之外
+    if (!(++i & 0x0f))
+        i = FB_OFF;
+    lcdFbPos = i;
+}
+
+void LcdFb_ShowString(uchar* s)
+{
+    while (*s)
+        LcdFb_WriteData(*s++);
+}
+
+// 放入写入队列 队列已满返回 0
+bit LcdFb_Push(bit rs, uchar byte)
+{
+    uchar i = lcdQHead;
+    uchar next = (i + 1) & Q_MASK;
+    if (next == lcdQTail)
+        return 0;
+    lcdQ[i] = byte;
+    if (rs)
+        lcdQRs |= LcdQBit[i];
+    else
+        lcdQRs &= ~LcdQBit[i]; // 中断只读取 Tail 的位 不会与这里冲突
+    lcdQHead = next; // 写好之后才交给中断
+    return 1;
+}
+
+bit LcdFb_FlushLimit(uchar n)
+{
+    uchar i, mask;
+    uchar idata* dirty;
+    bit located = 0; // LCD1602 的光标已经在当前单元
+    if (lcd_timeout)
+    { // 中断丢弃了队列 屏幕内容未知 (可能重新上电) 恢复后全部重新写入
+        lcd_timeout = 0;
+        i = FB_SIZE / 8;
+        do
+        {
+            lcdDirty[--i] = 0xff;
+        } while (i);
+        for (i = 0; i < 8; ++i)
+            if (glyphSlot[i] != GLYPH_NONE)
+                glyphPending |= LcdQBit[i];
+        glyphRow = 0;
+        lcdfb_dirty = 1;
+    }
+    if (!lcdfb_dirty)
+        return 0;
+    TRACE(TR_LCD_FLUSH, 0);
+    // 先写入改变了的字形 显示它的单元在之后写入
+    for (i = 0; glyphPending; ++i)
+    {
+        if (!(glyphPending & LcdQBit[i]))
+            continue;
+        if (!LcdFb_Push(0, 0x40 | (i << 3) | glyphRow)) // 命令7 CGRAM 地址
+            return 1;
+        do
+        {
+            if (!LcdFb_Push(1, LcdGlyph[glyphSlot[i]][glyphRow]))
+                return 1; // 队列已满 下次从这一行继续
+        } while (++glyphRow < 8);
+        glyphRow = 0;
+        glyphPending &= ~LcdQBit[i];
+    }
+    lcdfb_dirty = 0;
+    dirty = lcdDirty;
+    mask = 0x01;
+    for (i = 0; i < FB_SIZE; ++i)
+    {
+        if (*dirty & mask)
+        {
+            if (!n)
+                break;
+            if (!located)
+            {
+                if (!LcdFb_Push(0, (i & 0x10 ? 0xc0 : 0x80) | (i & 0x0f)))
+                    break;
+                located = 1;
+            }
+            if (!LcdFb_Push(1, lcdFb[i]))
+                break;
+            *dirty &= ~mask;
+            --n;
+        }
+        else
+            located = 0;
+        if ((i & 0x0f) == 0x0f)
+            located = 0; // 换行需要重新定位
+        mask <<= 1;
+        if (!mask)
+        {
+            mask = 0x01;
+            ++dirty;
+        }
+    }
+    if (i < FB_SIZE)
+        lcdfb_dirty = 1; // 队列已满 (或达到 n 个) 剩下的单元下次再放入
+    return lcdfb_dirty;
+}
+
+void LcdFb_Flush(void)
+{
+    LcdFb_FlushLimit(FB_SIZE);
+}
+
+/**
+ * 在 T0 中断中调用 每个节拍最多写入一个字节
+ * 开销: 队列为空约 6 个机器周期 写入一个字节约 40 个机器周期
+ */
+void LcdFb_Service(void)
+{
+    uchar i = lcdQTail;
+    if (i == lcdQHead)
+        return;
+    if (LCD1602_Busy())
+    {
+        if (++lcdQBusy >= Q_TIMEOUT)
+        { // LCD1602 失去响应 丢弃队列 不再占用节拍
+            lcdQBusy = 0;
+            lcdQTail = lcdQHead;
+            lcd_timeout = 1;
+        }
+        return;
+    }
+    lcdQBusy = 0;
+    LCD1602_Send(lcdQRs & LcdQBit[i], lcdQ[i]);
+    lcdQTail = (i + 1) & Q_MASK;
+}
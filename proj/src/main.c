@@ -8,9 +8,15 @@
  */
 #include "__config__.h"
 #include "at24c02.h"
+#include "control.h"
+#include "diag.h"
 #include "ds18b20.h"
 #include "i2c.h"
 #include "lcd1602.h"
+#include "lcdfb.h"
+#include "modbus.h"
+#include "trace.h"
+#include "uart.h"
 #include "ultimate.h"
 #include "utility.h"
 
@@ -28,25 +34,35 @@ extern bit convert_finished;
 extern bit dc_motor_working;
 extern bit above_upper_limit;
 extern bit below_lower_limit;
-extern bit ringtone_change;
 extern bit save_in_24c02;
 extern bit play_music;
+extern bit music_refill;
+extern bit boot_splash;
+extern bit history_sample;
+extern bit history_changed;
+extern bit checkpoint_event;
+extern bit checkpoint_dirty;
+extern bit sensor_update;
 
-extern float temperature, highest, lowest;
-extern uchar page, option, settingsSave;
+extern int temperature, highest, lowest; // 单位 1/16 度
+extern uchar page, option;
 extern uchar hus, hms, hs, hm, lus, lms, ls, lm;
-extern uchar dsr, fanGear, fanGearStep;
+extern uchar dsr, fanGear, fanGearStep, pwmCount;
 extern uchar ringRate, ringtoneNum;
 extern char upperLimit, lowerLimit;
 
-extern uint convertCount, dcmCount;
-extern uint SHOW_WAIT;
+extern uint convertCount, historyCount;
+extern uint tickCount, bootWait, decisionTick;
+extern uchar bootStep;
+extern uchar checkpointSeq, checkpointAge;
 
 extern uchar numStr[];
 extern uint code cttcn[];
 extern uint code FreqTable[];
-extern uchar idata musicArr[];
-extern uchar freqH, freqL, freqSelect;
+extern uchar idata musicBuf[][MUSIC_BUF_SIZE];
+extern uchar freqSelect, musicSel;
+extern uchar notePitch, noteLen, noteRepeat;
+extern bit note_dotted;
 extern uint freqDelay, freqSize;
 
 void init_data(void);          // 初始化数据
@@ -56,6 +72,9 @@ void UpdateViewPageShow(void); // 刷新视图显示
 
 void main(void)
 {
+#ifdef DIAG_ENABLE
+    Diag_StackPaint(); // 在任何压栈之前
+#endif
     /**
      * 初始化数据:
      * 1. 初始化 定时/计数器 对应的方式初值 优先级
@@ -68,9 +87,9 @@ void main(void)
     /**
      * 初始化程序:
      * 1. 开始温度转换
-     * 2. LCD1602初始化 显示开机界面
-     * 3. 以打字机效果显示主视图
-     * 4. 打开 定时/计数器中断 外部中断
+     * 2. LCD1602初始化 (开机动画在主循环中进行 不等待)
+     * 3. 打开 定时/计数器中断 外部中断
+     * 第一次温度转换完成后立即开始控制 不等开机动画结束
      */
     init_program();
     /**
@@ -91,28 +110,84 @@ void main(void)
      */
     while (1)
     {
+#ifdef TRACE_ENABLE
+        Trace_Service(); // 发送追踪缓冲的下一帧
+#endif
         if (settings_mode) // 设置模式
         {
             if (ready_settings)
             {
                 ready_settings = 0;
+                if (boot_splash)
+                { // 开机动画被打断 恢复光标自增并关闭光标 (清屏在 ShowSettings 中)
+                    boot_splash = 0;
+                    LCD1602_WriteCmd(Mode_CursorRightMove);
+                    LCD1602_WriteCmd(Show_CursorOff);
+                }
+                LcdFb_Invalidate(); // 设置模式直接改写 LCD1602 回到视图时全部刷新
+#ifdef UART_TELEMETRY
+                Telemetry_Event(TM_EV_SETTINGS);
+#endif
+#ifdef TRACE_ENABLE
+                Trace_Dump(); // 发送进入设置模式之前的追踪记录
+#endif
                 ShowSettings(0); // 显示设置模式 并指向第一条
             }
             KeysSystem_2(); // 第二套按键事件响应系统
         }
         else // 视图模式
         {
+#ifdef DIAG_ENABLE
+            Diag_Loop(); // 主循环一次的时间
+#endif
             if (save_in_24c02)
             {
                 save_in_24c02 = 0;
-                At24c02_WriteByte(0xa0, 0x00, &settingsSave, 1);
+                TRACE(TR_EE_CONFIG, 0);
+                CommitConfig(); // 设置没有改变时不写入
+#ifdef UART_TELEMETRY
+                Telemetry_Event(TM_EV_VIEW);
+#endif
             }
             if (convert_finished)
             { // 如果温度转换完成 更新温度信息
                 UpdateTemperature();
                 convert_finished = 0;
+#ifdef UART_TELEMETRY
+                Telemetry_Sample(); // 只放入发送缓冲 由串口中断发送
+#endif
+                if (!decisionTick)
+                { // 开机后第一次有效的温度和控制决策
+                    decisionTick = GetTickCount();
+                    AddHistory();
+                }
+            }
+            if (history_sample)
+            { // 每 15s 记录一次温度历史
+                history_sample = 0;
+                AddHistory();
+                if (checkpointAge != 0xff)
+                    ++checkpointAge;
+                // 限制写入 24c02 的频率 (约 5ms 的页写入 T0 照常工作)
+                if ((checkpoint_event && checkpointAge >= CHECKPOINT_MIN_AGE) ||
+                    (checkpoint_dirty && checkpointAge >= CHECKPOINT_MAX_AGE))
+                {
+                    TRACE(TR_EE_CHECKPOINT, checkpointSeq);
+                    SaveCheckpoint();
+                }
+            }
+            RefillMusic(); // 读取下一块音乐
+#ifdef UART_MODBUS
+            if (modbus_frame)
+                Modbus_Process(); // 处理请求 应答由串口中断发送
+#endif
+            if (boot_splash)
+                BootSplash(); // 开机动画的下一步
+            else
+            {
+                UpdateViewPageShow(); // 刷新视图显示 (写入影子显存)
+                LcdFb_Flush();        // 只把改变了的字符放入写入队列
             }
-            UpdateViewPageShow(); // 刷新视图显示
             KeysSystem_1();       // 第一套按键事件响应系统
         }
     }
@@ -122,133 +197,211 @@ void init_data(void)
 {
     EA = 0; // 初始化中断为关闭
     ET0 = 0;
-    ET1 = 0;
+    ET2 = 0;
     TR0 = 0;
-    TR1 = 0;
+    TR2 = 0;
     EX0 = 0;
 
     DCM = 0;   // 初始化电机不工作
     RELAY = 0; // 初始化继电器断开
 
-    TMOD = 0x12; // 定时器0 方式2 定时器1 方式1
+    TMOD = 0x02; // 定时器0 方式2 (定时器1 用于串口波特率)
     TH0 = 0x00;  // 自动装填
     TL0 = 0x00;  // 记 256 次
-    PT0 = 1;     // 高优先级
-    PT1 = 1;     // 高优先级
+    PT0 = 1;     // 高优先级 (发声时降为低优先级 见 init_music)
+
+    T2CON = 0x00; // 定时器2 16位自动重装 (重装值 RCAP2H RCAP2L)
+    PT2 = 1;      // 高优先级 发声时为唯一的高优先级中断
 
     PX0 = 0; // 低优先级
     IT0 = 1; // 下降沿触发
 
-    // 从 DS18B20 读取 温度上下限 分辨率
-    // DS18B20_Update();
-    DS18B20_Get(&upperLimit, &lowerLimit, &dsr);
-    // 从 24c02 读取 风扇档位步长 开机音乐序号 音频(分为0-7)
+#if defined(UART_TELEMETRY) || defined(UART_MODBUS)
+    Uart_Init(); // 定时器1 方式2 产生波特率 串口低优先级
+#endif
+
     // I2C_Init();
-    At24c02_ReadData(0xa0, 0x00, &settingsSave, 1);
-    ringRate = settingsSave & 0x07;
-    ringtoneNum = (settingsSave >> 3) & 0x03;
-    fanGearStep = (settingsSave >> 5) & 0x03;
+#ifdef EEPROM_IMAGE_LOADER
+    LoadEepromImage(); // 新板子或镜像版本改变 先写入初始镜像
+#endif
+    // 从 24c02 的配置记录读取 温度上下限 分辨率 风扇档位步长 开机音乐序号 音频(分为0-7)
+    LoadConfig();
     freqSize = 2144 - 256 * ringRate;
-    // 从 24c02 读取 铃声 放入ringtone
-    ReadMusic();
+    // 从 24c02 读取 控制参数 (回差 PI 系数)
+    At24c02_ReadData(AT24C02_SLA, EE_CONTROL, ctrlParam, CTRL_PARAM_NUM);
+    Control_Check();
+    Control_Reset();
+    // 从 24c02 恢复掉电前的 温度极值 越界计时
+    RestoreCheckpoint();
 }
 
 void init_program(void)
 {
-    DS18B20_Convert();                // 开始温度转换
-    LCD1602_Action();                 // lcd1602 初始化（开机）
-    UpdateTemperature();              // 更新温度信息
-    LCD1602_WriteCmd(Show_CursorOn);  // 打开光标
-    SHOW_WAIT = 40;                   // 开机打字机特效
-    ShowViewPage_1();                 // 显示首页
-    LCD1602_WriteCmd(Show_CursorOff); // 关闭光标
-    SHOW_WAIT = 0;
+    LCD1602_Action();     // lcd1602 初始化（开机）
+    InitHistory();        // 清空温度历史 第一次有效温度时记录第一个采样
     DS18B20_Convert();    // 开始温度转换
-    convert_finished = 0; // 打开温度转换定时
-    EA = 1;               // 总中断允许开启
-    ET0 = 1;              // 允许定时器中断
-    ET1 = 1;
+    convertCount = 0;     // 由 T0 计算转换时间 转换完成前不读取温度
+    convert_finished = 0; // (上电时 DS18B20 暂存器中是 85 度)
+#ifdef BOOT_SKIP_SPLASH
+    page_change = 1; // 不显示开机动画 直接显示主视图
+#else
+    boot_splash = 1; // 开机动画在主循环中进行 不等待
+    bootStep = 0;
+    bootWait = 0;
+#endif
+    tickCount = 0;
+    EA = 1;  // 总中断允许开启
+    ET0 = 1; // 允许定时器中断
+    ET2 = 1;
     TR0 = 1; // T0 开始工作
-    TR1 = 0; // T1 不工作
+    TR2 = 0; // T2 不工作 (报警时才发声)
     EX0 = 1; // 允许外部中断
+#ifdef UART_TELEMETRY
+    Telemetry_Event(TM_EV_BOOT);
+#endif
 }
 
 void init_music(void)
 {
+    ReadMusic(); // 从 24c02 读取铃声的起止地址 并预读两块缓冲
+    TF2 = 0;     // 清除TF2标志
     play_music = 1;
-    PT0 = 0;
-    TF1 = 0;    // 清除TF1标志
-    TH1 = 0xfc; // 设置定时器1初值
-    TL1 = 0x18;
-    freqSelect = 0;
+    PT0 = 0; // T0 降为低优先级 T2 的翻转不再被 T0 推迟
 }
 
 void UpdateTemperature(void)
 {
-    uchar i;
-    while (play_music && (freqDelay <= 24 || freqDelay >= 96))
+    uchar i, lost = 24; // 关中断期间停止的节拍
+    // 等待音符剩余的节拍多于 lost 且不在停顿 (96) 之前 补偿后不会越过
+    while (play_music && (freqDelay <= (sensor_update ? 24 + 16 : 24) || freqDelay >= 96))
     {
+        RefillMusic();
         KeysSystem_1();
-        if (page_change)
+        if (page_change && !boot_splash)
+        {
             UpdateViewPageShow();
+            LcdFb_Flush();
+        }
     }
     TR0 = 0;
     EA = 0; // 获取温度转化得关闭中断 否则会破坏 DS18B20 的时序 造成错误
-    temperature = DS18B20_ReadTemp(); // 获取温度计转换的温度
+    TRACE_RAW(TR_SENSOR_IN, 0);
+    temperature = DS18B20_ReadTemp(); // 获取温度计转换的温度 (单位 1/16 度)
+    if (sensor_update)
+    { // 串口修改了设置 中断已关闭 写入暂存器 约 1075+5*585+30 加 66 共 16 * 256 个机器周期
+        sensor_update = 0;
+        DS18B20_Set(upperLimit, lowerLimit, dsr);
+        i = 33;
+        do
+        {
+        } while (--i);
+        lost = 24 + 16;
+    }
     DS18B20_Convert();
-    i = 35;
+    TRACE_RAW(TR_SENSOR_OUT, temperature >> 4);
+    i = 39;
     do
     {
-    } while (--i); // 85个机器周期 共约 2+1+5815+70 个机器周期
-    EA = 1; // 假设触发定时中断 23 次 可能有一些误差 但非常小
+    } while (--i); // 78个机器周期 共约 2+1+6063+78 = 24 * 256 个机器周期
+#ifdef UART_MODBUS
+    if (RI)
+        Modbus_Overrun(); // 关中断期间收到了字节 之后的字节已丢失
+#endif
+    /**
+     * 假设触发定时中断 lost 次 可能有一些误差 但非常小
+     * Modbus 的帧间静默 (MODBUS_T35) 在此期间停止计数 帧结束的判断最多推迟 lost 个节拍 (约 6.7ms 写入设置时 11ms)
+     * 不会提前 关中断期间收到字节时 Modbus_Overrun 丢弃该帧
+     */
+    EA = 1;
     TR0 = 1;
     if (play_music)
-        freqDelay -= 23;
-    temperature *= 0.0625; // 转化为可读温度
+        freqDelay -= lost;
     // 更新温度最大最小值
     if (temperature > highest)
+    {
         highest = temperature;
+        checkpoint_event = 1;
+    }
     if (temperature < lowest)
+    {
         lowest = temperature;
-    // 比较温度是否越界 并采取措施
-    if (temperature > upperLimit) // 高于温度上限
+        checkpoint_event = 1;
+    }
+    // 由控制引擎决定是否越界 (含回差) 和风扇占空比
+    Control_Update(temperature, upperLimit, lowerLimit, fanGearStep);
+    if (ctrl_above) // 高于温度上限
     {
+#ifdef UART_TELEMETRY
+        if (!above_upper_limit)
+            Telemetry_Event(TM_EV_ABOVE);
+#endif
         above_upper_limit = 1; // 设置上越界标志位
         dc_motor_working = 1;  // 直流电机开始工作
-        fanGear = (temperature - upperLimit) / fanGearStep + 1;
-        if (fanGear > 3)
+        checkpoint_dirty = 1;  // 越界计时改变
+        // 显示的档位: 1 档 40% 以上 2 档 70% 以上 3 档 全速
+        if (ctrlDuty >= FAN_PWM_LEVELS)
             fanGear = 3;
-        i = 23;
-        do
+        else if (ctrlDuty >= FAN_PWM_LEVELS * 7 / 10)
+            fanGear = 2;
+        else
+            fanGear = 1;
+        if (ctrl_raw_above) // 回差范围内不计时
         {
-            AboveLimitClock(); // 上越界定时
-        } while (--i);
+            i = lost;
+            do
+            {
+                AboveLimitClock(); // 上越界定时
+            } while (--i);
+        }
         if (!play_music)
             init_music();
     }
-    else if (temperature < lowerLimit) // 低于温度下限
+    else if (ctrl_below) // 低于温度下限
     {
+#ifdef UART_TELEMETRY
+        if (!below_lower_limit)
+            Telemetry_Event(TM_EV_BELOW);
+#endif
         below_lower_limit = 1; // 设置下越界标志位
+#ifdef TRACE_ENABLE
+        if (!RELAY)
+            TRACE(TR_RELAY, 1);
+#endif
         RELAY = 1;             // 闭合继电器
-        i = 21;
-        do
+        checkpoint_dirty = 1;  // 越界计时改变
+        if (ctrl_raw_below)
         {
-            BelowLimitClock(); // 下越界定时
-        } while (--i);
+            i = lost - 2;
+            do
+            {
+                BelowLimitClock(); // 下越界定时
+            } while (--i);
+        }
         if (!play_music)
             init_music();
     }
     else // 温度正常
     {
+        if (above_upper_limit || below_lower_limit)
+        {
+            checkpoint_event = 1; // 越界结束 记录最终的计时
+#ifdef UART_TELEMETRY
+            Telemetry_Event(TM_EV_NORMAL);
+#endif
+        }
         BUZZER = 1;
+#ifdef TRACE_ENABLE
+        if (RELAY)
+            TRACE(TR_RELAY, 0);
+#endif
         RELAY = 0;             // 断开继电器
         dc_motor_working = 0;  // 直流电机停止工作
         fanGear = 0;           // 直流电机档位置0
         below_lower_limit = 0; // 下越界标志位清0
         above_upper_limit = 0; // 上越界标志位清0
-        PT0 = 1;
-        TR1 = 0;
+        TR2 = 0;
         play_music = 0;
+        PT0 = 1; // 音乐停止 T0 恢复高优先级
     }
 }
 
@@ -263,13 +416,12 @@ void UpdateViewPageShow(void)
             page_change = 0;
         }
         // 刷新温度值显示
-        LCD1602_WriteCmd(Move_Cursor_Row2_Col(2));
-        FloatToString(temperature, numStr, 5, 1);
-        LCD1602_ShowString(numStr);
+        LcdFb_Cursor(Move_Cursor_Row2_Col(2));
+        ShowTemperature();
         // 刷新风扇档位显示
-        LCD1602_WriteCmd(Move_Cursor_Row2_Col(15));
+        LcdFb_Cursor(Move_Cursor_Row2_Col(15));
         Int8ToString(fanGear, numStr, 1);
-        LCD1602_ShowString(numStr);
+        LcdFb_ShowString(numStr);
         break;
     case 0xbf: // 最高/最低温(温度极值)查询视图
         if (page_change)
@@ -278,9 +430,9 @@ void UpdateViewPageShow(void)
             page_change = 0;
         }
         // 刷新显示温度的极值
-        LCD1602_WriteCmd(Move_Cursor_Row1_Col(9));
+        LcdFb_Cursor(Move_Cursor_Row1_Col(9));
         UpdateExtremes(1);
-        LCD1602_WriteCmd(Move_Cursor_Row2_Col(9));
+        LcdFb_Cursor(Move_Cursor_Row2_Col(9));
         UpdateExtremes(0);
         break;
     case 0xdf: // 温度越界计时视图
@@ -292,13 +444,13 @@ void UpdateViewPageShow(void)
         // 如果温度高于上限 刷新显示上越界计时
         if (above_upper_limit)
         {
-            LCD1602_WriteCmd(Move_Cursor_Row1_Col(8));
+            LcdFb_Cursor(Move_Cursor_Row1_Col(8));
             UpdateOverLimitTimer(1);
         }
         // 如果温度低于下限 刷新显示下越界计时
         else if (below_lower_limit)
         {
-            LCD1602_WriteCmd(Move_Cursor_Row2_Col(8));
+            LcdFb_Cursor(Move_Cursor_Row2_Col(8));
             UpdateOverLimitTimer(0);
         }
 
@@ -310,52 +462,118 @@ void UpdateViewPageShow(void)
         }
         // 没有需要刷新的可变量
         break;
+    case 0x3f: // 温度历史曲线视图 (在极值视图再按一次 S2)
+        if (page_change)
+        { // 如果视图改变 刷新整个屏幕内容显示
+            ShowViewPage_5();
+            page_change = 0;
+        }
+        else if (history_changed)
+            UpdateHistory(); // 有新的采样 刷新曲线
+        break;
+#ifdef DIAG_ENABLE
+    case 0x2f: // 诊断视图 (在设置查询视图再按一次 S4)
+        if (page_change)
+        { // 如果视图改变 刷新整个屏幕内容显示
+            ShowViewPage_6();
+            page_change = 0;
+        }
+        else
+            UpdateDiag(); // 统计一直在变 每次都刷新 (只有改变的字符写入 LCD1602)
+        break;
+#endif
     }
 }
 
 void UpdateAboutTimer(void)
 {
+    uint freq;
+    uchar note;
+    ++tickCount; // 全局节拍
     // 根据分辨率调整温度转换需要的时间
     if (!convert_finished && ++convertCount >= cttcn[dsr])
     {
         convertCount = 0;
         convert_finished = 1;
     }
-    // 将直流电机的方波分成 3段 根据档位决定某一段 电平高低
+#ifdef UART_MODBUS
+    // Modbus 帧间静默 最后一个字节之后 3.5 个字符
+    if (mbSilence && !--mbSilence)
+        modbus_frame = 1;
+#endif
+    // 温度历史采样定时 15s
+    if (++historyCount >= HISTORY_TICKS)
+    {
+        historyCount = 0;
+        history_sample = 1;
+    }
+    // 风扇 PWM: FAN_PWM_LEVELS 个节拍一个周期 前 ctrlDuty 个节拍导通
     if (dc_motor_working)
     {
-        if (++dcmCount >= 1440)       // 0.4s
-            if (dcmCount >= 2520)     // 0.7s
-                if (dcmCount >= 3600) // 1.0s
-                    dcmCount = 0;
-                else // 0.7s - 1.0s
-                    DCM = fanGear >= 0x03;
-            else // 0.4s - 0.7s
-                DCM = fanGear >= 0x02;
-        else // 0.0s - 0.4s
-            DCM = fanGear >= 0x01;
+        pwmCount = (pwmCount + 1) & (FAN_PWM_LEVELS - 1);
+        DCM = pwmCount < ctrlDuty;
     }
     else
         DCM = 0;
-    // 过界定时 需要 32个机器周期
-    if (above_upper_limit)
+    // 过界定时 需要 32个机器周期 按不含回差的限值计时 (与原来相同)
+    if (ctrl_raw_above)
         AboveLimitClock();
-    else if (below_lower_limit)
+    else if (ctrl_raw_below)
         BelowLimitClock();
 
     if (play_music)
         if (--freqDelay == 96)
-            TR1 = 0;
+        { // 不同音符间短暂停顿
+            TR2 = 0;
+            BUZZER = 1;
+        }
         else if (!freqDelay)
         {
-            TR1 = 1;
-            if (musicArr[freqSelect] == 0xff)
-                freqSelect = 0;
-            freqH = FreqTable[musicArr[freqSelect]] >> 8;
-            freqL = FreqTable[musicArr[freqSelect]] & 0xff;
-            ++freqSelect;
-            freqDelay = freqSize * musicArr[freqSelect]; // 选择音符对应的时长
-            ++freqSelect;
+            /**
+             * 解码一个音符 (格式见 __config__.h) 一般只读1字节 附点多读1字节
+             * 重复的音符不读取缓冲 解码约 60 个机器周期 加上乘法仍在 T0 预算内
+             */
+            if (noteRepeat)
+                --noteRepeat; // 重复上一个音符
+            else
+            {
+                do
+                {
+                    if (freqSelect == MUSIC_BUF_SIZE)
+                    {
+                        if (music_refill)
+                        { // 下一块还未读取完成 下个节拍再尝试
+                            TRACE(TR_NOTE_STALL, 0);
+                            freqDelay = 1;
+                            return;
+                        }
+                        // 切换到已读取好的另一块 并通知主循环读取下一块
+                        musicSel = !musicSel;
+                        freqSelect = 0;
+                        music_refill = 1;
+                    }
+                    note = musicBuf[musicSel][freqSelect++];
+                    if (note == NOTE_DOT)
+                        note_dotted = 1;
+                } while (note == NOTE_DOT);
+                if ((note & 0x3f) == NOTE_RUN)
+                    noteRepeat = note >> 6; // 本次即为第一次重复
+                else
+                {
+                    notePitch = note & 0x3f;
+                    noteLen = 1 << (note >> 6);
+                    if (note_dotted)
+                        noteLen += noteLen >> 1;
+                    note_dotted = 0;
+                }
+            }
+            TRACE(TR_NOTE, notePitch);
+            // 半周期作为 T2 的重装值 之后由硬件自动重装
+            freq = FreqTable[notePitch];
+            RCAP2H = TH2 = freq >> 8;
+            RCAP2L = TL2 = freq & 0xff;
+            TR2 = freq != 0; // 如果是休止符(0)，那么不播放声音，只进行延时
+            freqDelay = freqSize * noteLen; // 选择音符对应的时长
         }
 }
 
@@ -364,6 +582,7 @@ void UpdateAboutTimer(void)
  * 设定:
  *     外部中断0 为低优先级 可以被定时器中断 给中断
  *     否则 外部中断会破坏 T0 产生的时序
+ *     发声时 T0 为低优先级 消抖期间临时提高 T0 (只在按下 INT0 时 T2 与 T0 同级)
  *     设置模式下会关闭定时器 因为没有继续定时的必要
  * 思路:
  *     外部中断通过软件延迟 每0.05s判断一次是否仍然处于 按下且仅按下 INT0
@@ -376,6 +595,15 @@ void int_X0() interrupt 0
 {
     uchar ky; // 临时用来接收按键操作
     uchar i = 20;
+#ifdef DIAG_ENABLE
+    uint t;
+    EA = 0; // T0 可能在读取两个字节之间修改节拍
+    t = tickCount;
+    EA = 1;
+    ++diagCount[DIAG_X0];
+#endif
+    TRACE_X0(TR_X0_IN);
+    PT0 = 1; // 消抖需要数十毫秒 T0 必须能打断 X0
     KEYS = 0xff;
     do
     {
@@ -387,20 +615,26 @@ void int_X0() interrupt 0
             ky = 0x03;
             ky |= KEYS;
             if (ky != 0xfb)
+            {
+                PT0 = !play_music;
+                TRACE_X0(TR_X0_OUT);
                 return;
+            }
         }
         Delay1ms(50);
     } while (--i);
+#ifdef DIAG_ENABLE
+    EA = 0;
+    t = tickCount - t; // 长按的消抖 (设置模式中 T0 停止 为 0)
+    EA = 1;
+    if (t > diagX0Max)
+        diagX0Max = t;
+#endif
     if (settings_mode) // 退出设置模式
     {
-        // 将设置的内容存储至 DS18B20
+        // 分辨率写入 DS18B20 的暂存器 (不再复制到它的 EEPROM 配置保存在 24c02)
         DS18B20_Set(upperLimit, lowerLimit, dsr);
-        DS18B20_Save();
-        // 将设置的内容存储至 24lc02
-        settingsSave = 0xff;
-        settingsSave &= (fanGearStep << 5) | (ringtoneNum << 3) | (ringRate);
-        if (ringtone_change)
-            ReadMusic();
+        // 将设置的内容存储至 24lc02 的配置记录
         /**
          * @bug 不知道为什么 只要在此放下
          * AT24C02_WriteData(0xa0,0x00,&settingsSave,1) / Byte(...)
@@ -424,7 +658,7 @@ void int_X0() interrupt 0
     {
         ET0 = 0;
         TR0 = 0;        // 关闭定时计器T0
-        TR1 = 0;        // 关闭定时计器T1
+        TR2 = 0;        // 关闭定时计器T2
         BUZZER = 1;     // 关闭蜂鸣器
         RELAY = 0;      // 断开继电器
         DCM = 0;        // 关闭直流电机
@@ -433,7 +667,10 @@ void int_X0() interrupt 0
         // 可以设定一个标志 让主函数调用一次 ready_settings
         ready_settings = 1; // 进入设置模式 刷新设置模式显示
     }
+    TRACE(TR_MODE, !settings_mode);
     settings_mode = !settings_mode;
+    PT0 = !play_music;
+    TRACE_X0(TR_X0_OUT);
 }
 
 /**
@@ -451,23 +688,84 @@ void int_X0() interrupt 0
  */
 void int_T0() interrupt 1 using 1 // 指定寄存器组提高程序效率 减少误差
 {
+#ifdef DIAG_ENABLE
+    uchar lat = TL0, ex; // T0 从 0 开始计数 进入时的 TL0 即响应延迟
+#endif
+    TRACE_T0(TR_T0_IN);
     UpdateAboutTimer();
+    LcdFb_Service(); // 写入 LCD1602 队列中的一个字节
+    TRACE_T0(TR_T0_OUT);
+#ifdef DIAG_ENABLE
+    ex = TF0 ? 0xff : TL0 - lat; // 又一次溢出: 超过一个节拍
+    DIAG_ISR(DIAG_T0, lat, ex);
+    EA = 0; // 发声时 T0 为低优先级 T2 也会修改 diagBusy
+    diagBusy += ex;
+    if (!(uchar)tickCount)
+    { // 每 256 个节拍 (约 71ms) 更新一次 CPU 占用
+        diagLoad = diagBusy >> 8;
+        diagBusy = 0;
+    }
+    EA = 1;
+#endif
 }
 
-void int_T1() interrupt 3 using 2 // 指定寄存器组提高程序效率 减少误差
+#if defined(UART_TELEMETRY) || defined(UART_MODBUS)
+/**
+ * 串口中断函数
+ * 设定:
+ *     低优先级 与 X0 相同 不会推迟 T2 (平时也不推迟 T0)
+ *     发声时 T0 也是低优先级 与串口互不打断 串口中断只处理一个字节 推迟 T0 远不到一个节拍
+ *     不指定寄存器组 Uart_Service 与主循环一样使用寄存器组0
+ * 思路:
+ *     遥测: 只发送 每发送完一个字节 (TI) 从发送缓冲中取下一个字节
+ *     Modbus: 接收的字节放入请求缓冲 发送应答的下一个字节
+ */
+void int_UART() interrupt 4
 {
-    if (freqH || freqL) // 如果是休止符(0)，那么不播放声音，只进行延时
-    {
-        // 取对应频率值的重装载值到定时器(确认音高) musicArr[musicSelect]
-        TH1 = freqH; // 设置高位定时初值
-        TL1 = freqL; // 设置低位定时初值
-        // 翻转蜂鸣器IO口(注意这里的重装值是周期的一半，故仅进行一次蜂鸣器的翻转)
-        BUZZER = !BUZZER;
-    }
-    if (TF0)
-    {
-        TF0 = 0;
-        UpdateAboutTimer();
-    }
+#ifdef DIAG_ENABLE
+    uchar in = TL0, ex;
+    uchar hits = (uchar)diagCount[DIAG_T0] + (uchar)diagCount[DIAG_T2];
+#endif
+    TRACE_UART(TR_UART_IN);
+#ifdef UART_MODBUS
+    Modbus_Service();
+#else
+    Uart_Service();
+#endif
+    TRACE_UART(TR_UART_OUT);
+#ifdef DIAG_ENABLE
+    ex = TL0 - in;
+    if (TR0 && hits == (uchar)diagCount[DIAG_T0] + (uchar)diagCount[DIAG_T2])
+        DIAG_EXEC(DIAG_UART, ex);
+    else
+        ++diagCount[DIAG_UART]; // 被 T0 T2 打断 (或 T0 停止) 只计次数
+#endif
 }
+#endif
 
+/**
+ * T2 中断函数
+ * 设定:
+ *     定时器 T2 16位自动重装 重装值 RCAP2H RCAP2L 为当前音符的半周期
+ * 思路:
+ *     重装由硬件在溢出瞬间完成 不受中断响应延迟的影响 音高准确且没有累积误差
+ *     中断内只需清除溢出标志 并翻转一次蜂鸣器
+ *     发声时为唯一的高优先级中断 (T0 在 init_music 中降为低优先级) 翻转只推迟当前指令
+ *     (T2 时钟输出需要蜂鸣器接在 T2/P1.0 上 而 P1.0 已用作 LCD1602 的 RS)
+ */
+void int_T2() interrupt 5 using 2 // 指定寄存器组提高程序效率 减少误差
+{
+#ifdef DIAG_ENABLE
+    uchar in = TL2, lat, ex;
+    lat = in - RCAP2L; // 重装后经过的机器周期
+#endif
+    TF2 = 0; // T2 的溢出标志不会被硬件清除
+    TRACE_T2(TR_T2_IN);
+    BUZZER = !BUZZER;
+    TRACE_T2(TR_T2_OUT);
+#ifdef DIAG_ENABLE
+    ex = TL2 - in;
+    DIAG_ISR(DIAG_T2, lat, ex);
+    diagBusy += ex;
+#endif
+}
@@ -0,0 +1,296 @@
+/**
+ * modbus.c
+ * 日期：2026/10/19
+ * ----------------------------------------------
+ * 请求和应答共用一个缓冲 mbBuf
+ *   接收: 串口中断放入 每个字节重新开始 3.5 个字符的静默计时 (mbSilence)
+ *         T0 计时到 0 置位 modbus_frame 之后中断不再接收
+ *   处理: 主循环检查地址和 CRC 执行请求 在 mbBuf 中写好应答
+ *   发送: 置 mb_tx 和 TI 由串口中断逐个字节发送 发送完回到接收
+ * 不检查字符间 1.5 个字符的间隔 出错的帧由 CRC 排除
+ * 读取温度时关中断约 6.7ms (9600 波特约 6 个字符 写入了设置时约 11ms) 串口只保存最后收到的 1 个字节
+ *   关中断期间有字节到达时 由 Modbus_Overrun 丢弃正在接收的帧 不依靠 CRC 碰巧排除
+ */
+#include "__config__.h"
+#include "at24c02.h"
+#include "control.h"
+#include "modbus.h"
+
+#ifdef UART_MODBUS
+
+#define uint unsigned int
+#define uchar unsigned char
+
+#define MB_HOLDING_NUM 6
+#define MB_INPUT_NUM   8
+#define MB_READ_PAGE   0x41 // 用户定义功能码 读 24c02 的一页
+
+// 异常码
+#define MB_ILLEGAL_FUNCTION 0x01
+#define MB_ILLEGAL_ADDRESS  0x02
+#define MB_ILLEGAL_VALUE    0x03
+
+extern bit save_in_24c02, sensor_update, page_change;
+extern bit above_upper_limit, below_lower_limit, dc_motor_working;
+extern int temperature, highest, lowest;
+extern uchar hs, hm, ls, lm;
+extern uchar fanGear, fanGearStep, dsr, ringtoneNum, ringRate;
+extern char upperLimit, lowerLimit;
+extern uint freqSize;
+
+uchar idata mbBuf[MODBUS_BUF_SIZE]; // 请求 应答
+uchar mbLen = 0;     // 缓冲中的字节数 0xff: 溢出
+uchar mbPos = 0;     // 发送位置
+uchar mbSilence = 0; // 距离 3.5 个字符的静默还有多少个 T0 节拍
+bit modbus_frame = 0; // 收到一帧 等待主循环处理
+bit mb_tx = 0;        // 正在发送应答
+
+// CRC-16 (多项式 0xa001 反射) 每 4 位查一次表 表只有 16 项
+uint code Crc16Nibble[16] = {
+    0x0000, 0xcc01, 0xd801, 0x1400, 0xf001, 0x3c00, 0x2800, 0xe401,
+    0xa001, 0x6c00, 0x7800, 0xb401, 0x5000, 0x9c01, 0x8801, 0x4400,
+};
+
+uint Crc16(uchar* dat, uchar num)
+{
+    uint crc = 0xffff;
+    while (num--)
+    {
+        crc ^= *dat++;
+        crc = (crc >> 4) ^ Crc16Nibble[crc & 0x0f];
+        crc = (crc >> 4) ^ Crc16Nibble[crc & 0x0f];
+    }
+    return crc;
+}
+
+void Modbus_Service(void)
+{
+    uchar i;
+    if (RI)
+    {
+        RI = 0;
+        if (!modbus_frame && !mb_tx)
+        {
+            i = mbLen;
+            if (i < MODBUS_BUF_SIZE)
+            {
+                mbBuf[i] = SBUF;
+                mbLen = i + 1;
+            }
+            else
+                mbLen = 0xff; // 溢出 整帧丢弃
+            mbSilence = MODBUS_T35;
+        }
+    }
+    if (TI)
+    {
+        TI = 0;
+        i = mbPos;
+        if (i < mbLen)
+        {
+            SBUF = mbBuf[i];
+            mbPos = i + 1;
+        }
+        else
+        { // 应答发送完 回到接收
+            mbLen = 0;
+            mb_tx = 0;
+        }
+    }
+}
+
+void Modbus_Overrun(void)
+{
+    if (!modbus_frame && !mb_tx)
+        mbLen = 0xff; // 与缓冲溢出相同 静默后整帧丢弃
+}
+
+uint Modbus_Input(uchar i)
+{
+    uint v;
+    uchar m, s;
+    switch (i)
+    {
+    case 0:
+        return temperature;
+    case 1:
+        return highest;
+    case 2:
+        return lowest;
+    case 3:
+    case 4:
+        EA = 0; // T0 的越界计时可能在读取分和秒之间进位
+        if (i == 3)
+            m = hm, s = hs;
+        else
+            m = lm, s = ls;
+        EA = 1;
+        return m * 60 + s;
+    case 5:
+        return fanGear;
+    case 6:
+        return ctrlDuty;
+    }
+    v = 0;
+    if (above_upper_limit)
+        v |= 0x01;
+    if (below_lower_limit)
+        v |= 0x02;
+    if (dc_motor_working)
+        v |= 0x04;
+    return v;
+}
+
+/**
+ * 写入保持寄存器 first 开始的 num 个 值在 dat 中 (高字节在前)
+ * 先在副本中修改 全部在范围内才生效 返回 0 表示有值超出范围
+ * 范围与设置模式相同 (ultimate.c ChangeSetting)
+ */
+bit Modbus_WriteHolding(uchar first, uchar num, uchar* dat)
+{
+    int v[MB_HOLDING_NUM];
+    uchar i;
+    v[0] = upperLimit;
+    v[1] = lowerLimit;
+    v[2] = dsr;
+    v[3] = fanGearStep;
+    v[4] = ringtoneNum;
+    v[5] = ringRate;
+    for (i = first; num; --num, ++i, dat += 2)
+        v[i] = (dat[0] << 8) | dat[1];
+    if (v[0] > 127 || v[1] < -55 || v[0] <= v[1] || (uint)v[2] > 3 ||
+        (uint)v[3] > 7 || (uint)v[4] > 3 || (uint)v[5] > 7)
+        return 0;
+    // 与退出设置模式相同: 分辨率写入 DS18B20 暂存器 (下一次转换时) 提交配置记录
+    upperLimit = v[0];
+    lowerLimit = v[1];
+    dsr = v[2];
+    fanGearStep = v[3];
+    ringtoneNum = v[4];
+    ringRate = v[5];
+    freqSize = 2144 - 256 * ringRate;
+    sensor_update = 1;
+    save_in_24c02 = 1;
+    page_change = 1; // 设置查询视图显示新的值
+    return 1;
+}
+
+// 丢弃请求 回到接收
+void Modbus_Discard(void)
+{
+    mbLen = 0;
+    modbus_frame = 0;
+}
+
+void Modbus_Process(void)
+{
+    uchar len = mbLen, fc, first, num, i;
+    uint crc, v;
+    uchar idata* p;
+    if (len < 4 || len > MODBUS_BUF_SIZE ||
+        (mbBuf[0] != MODBUS_ADDR && mbBuf[0] != 0))
+    { // 不完整 溢出 或不是发给本机的
+        Modbus_Discard();
+        return;
+    }
+    crc = Crc16(mbBuf, len - 2);
+    if (mbBuf[len - 2] != (crc & 0xff) || mbBuf[len - 1] != (crc >> 8))
+    {
+        Modbus_Discard();
+        return;
+    }
+    fc = mbBuf[1];
+    first = mbBuf[3]; // 寄存器地址的高字节必须为 0
+    num = mbBuf[5];
+    i = 0; // 异常码
+    switch (fc)
+    {
+    case 0x03: // 读保持寄存器
+    case 0x04: // 读输入寄存器
+        if (len != 8)
+            i = MB_ILLEGAL_VALUE;
+        else if (mbBuf[2] || mbBuf[4] || !num ||
+                 first + num > (fc == 0x03 ? MB_HOLDING_NUM : MB_INPUT_NUM))
+            i = MB_ILLEGAL_ADDRESS;
+        else
+        {
+            mbBuf[2] = num << 1;
+            p = mbBuf + 3;
+            for (; num; --num, ++first)
+            {
+                if (fc == 0x04)
+                    v = Modbus_Input(first);
+                else
+                    switch (first)
+                    {
+                    case 0: v = upperLimit; break;
+                    case 1: v = lowerLimit; break;
+                    case 2: v = dsr; break;
+                    case 3: v = fanGearStep; break;
+                    case 4: v = ringtoneNum; break;
+                    default: v = ringRate; break;
+                    }
+                *p++ = v >> 8;
+                *p++ = v & 0xff;
+            }
+            len = p - mbBuf;
+        }
+        break;
+    case 0x06: // 写单个保持寄存器 应答与请求相同
+        if (len != 8)
+            i = MB_ILLEGAL_VALUE;
+        else if (mbBuf[2] || first >= MB_HOLDING_NUM)
+            i = MB_ILLEGAL_ADDRESS;
+        else if (!Modbus_WriteHolding(first, 1, mbBuf + 4))
+            i = MB_ILLEGAL_VALUE;
+        else
+            len = 6;
+        break;
+    case 0x10: // 写多个保持寄存器 应答为起始地址和个数
+        if (len != 9 + 2 * num || mbBuf[6] != 2 * num || mbBuf[4])
+            i = MB_ILLEGAL_VALUE;
+        else if (mbBuf[2] || !num || first + num > MB_HOLDING_NUM)
+            i = MB_ILLEGAL_ADDRESS;
+        else if (!Modbus_WriteHolding(first, num, mbBuf + 7))
+            i = MB_ILLEGAL_VALUE;
+        else
+            len = 6;
+        break;
+    case MB_READ_PAGE: // 读 24c02 的一页
+        first = mbBuf[2];
+        if (len != 5)
+            i = MB_ILLEGAL_VALUE;
+        else if (first > 0x0f)
+            i = MB_ILLEGAL_ADDRESS;
+        else
+        {
+            At24c02_ReadData(AT24C02_SLA, first << 4, mbBuf + 3, 16);
+            len = 3 + 16;
+        }
+        break;
+    default:
+        i = MB_ILLEGAL_FUNCTION;
+        break;
+    }
+    if (!mbBuf[0])
+    { // 广播 只执行 不应答
+        Modbus_Discard();
+        return;
+    }
+    if (i)
+    { // 异常应答
+        mbBuf[1] = fc | 0x80;
+        mbBuf[2] = i;
+        len = 3;
+    }
+    crc = Crc16(mbBuf, len);
+    mbBuf[len++] = crc & 0xff; // CRC 低字节在前
+    mbBuf[len++] = crc >> 8;
+    mbLen = len;
+    mbPos = 0;
+    mb_tx = 1; // 先置位 mb_tx 中断才不会在清除 modbus_frame 后接收
+    modbus_frame = 0;
+    TI = 1; // 由串口中断发送
+}
+
+#endif // UART_MODBUS
@@ -0,0 +1,63 @@
+/**
+ * trace.c
+ * 日期：2026/10/19
+ * ----------------------------------------------
+ * 追踪缓冲的发送: 一帧 TRACE_PER_FRAME 条记录 发送缓冲有空间时才放入 不计为丢帧
+ * 帧: TM_TRACE 序号 第一条记录的下标 记录总数 记录 ... (从最早的一条开始)
+ */
+#include "__config__.h"
+#include "trace.h"
+#include "uart.h"
+#include "ultimate.h"
+
+#define uint unsigned int
+#define uchar unsigned char
+
+#ifdef TRACE_ENABLE
+
+#define TRACE_PER_FRAME 2 // 编码后 15 字节 (发送缓冲 UART_TX_SIZE)
+
+extern uchar telemetrySeq;
+
+uchar idata traceBuf[TRACE_SIZE * 4];
+uchar traceHead = 0;
+bit trace_hold = 0;
+bit trace_wrapped = 0;
+uchar traceDump = 0; // 下一条发送的记录
+
+void Trace_Dump(void)
+{
+    if (trace_hold)
+        return; // 上一次还没有发送完
+    trace_hold = 1;
+    traceDump = 0;
+}
+
+void Trace_Service(void)
+{
+    uchar frame[4 + TRACE_PER_FRAME * 4];
+    uchar n, i, j, pos;
+    if (!trace_hold || Uart_TxFree() < sizeof(frame) + 3)
+        return;
+    n = trace_wrapped ? TRACE_SIZE : traceHead >> 2;
+    frame[0] = TM_TRACE;
+    frame[1] = telemetrySeq++;
+    frame[2] = traceDump;
+    frame[3] = n;
+    pos = ((trace_wrapped ? traceHead : 0) + (traceDump << 2)) & TRACE_MASK; // 最早的一条开始
+    for (i = 4; i < sizeof(frame) && traceDump < n; ++traceDump)
+        for (j = 4; j; --j)
+        {
+            frame[i++] = traceBuf[pos];
+            pos = (pos + 1) & TRACE_MASK;
+        }
+    Uart_SendFrame(frame, i);
+    if (traceDump >= n)
+    { // 发送完 清空后继续记录
+        traceHead = 0;
+        trace_wrapped = 0;
+        trace_hold = 0;
+    }
+}
+
+#endif // TRACE_ENABLE
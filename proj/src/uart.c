@@ -0,0 +1,115 @@
+/**
+ * uart.c
+ * 日期：2026/10/19
+ * ----------------------------------------------
+ * 发送环形缓冲: Uart_SendFrame (主循环) 放入 Uart_Service (串口中断) 取出
+ * 一帧在缓冲区中编码完成后才移动 uartTxHead 中断不会发送半帧
+ * 发送空闲时 (uart_tx_idle) 由主循环置 TI 启动中断 之后每发送完一个字节
+ * 中断自己取下一个 9600 波特约 1ms 一个字节
+ */
+#include "__config__.h"
+#include "uart.h"
+#include "utility.h"
+
+#define uint unsigned int
+#define uchar unsigned char
+
+#if defined(UART_TELEMETRY) || defined(UART_MODBUS)
+void Uart_Init(void)
+{
+    TMOD = (TMOD & 0x0f) | 0x20; // 定时器1 方式2 自动装填
+    TH1 = UART_RELOAD;
+    TL1 = UART_RELOAD;
+    PCON &= 0x7f; // SMOD = 0
+#ifdef UART_MODBUS
+    SCON = 0x50; // 方式1 允许接收
+#else
+    SCON = 0x40; // 方式1 只发送
+#endif
+    PS = 0; // 低优先级 不推迟 T0
+    TR1 = 1;
+    ES = 1; // 总中断在 init_program 中打开
+}
+#endif
+
+#ifdef UART_TELEMETRY
+
+#define TX_MASK (UART_TX_SIZE - 1)
+
+uchar idata uartTx[UART_TX_SIZE];   // 发送缓冲
+uchar uartTxHead = 0, uartTxTail = 0; // 主循环写 Head 中断写 Tail
+bit uart_tx_idle = 1;               // 没有正在发送的字节
+uchar uartDrops = 0;
+
+/**
+ * COBS: 每个 0x00 替换为 到下一个 0x00 (或结尾) 的距离 开头加一个距离字节
+ * 帧长度 (含 CRC) 小于 254 不需要拆分 编码后长度为 num + 2 再加分隔符
+ * 直接编码到缓冲区中: 先留出距离字节的位置 遇到 0x00 或结尾时填入
+ */
+bit Uart_SendFrame(uchar* dat, uchar num)
+{
+    uchar head, distPos, dist, b, crc;
+    if (((uartTxTail - uartTxHead - 1) & TX_MASK) < num + 3)
+    {
+        if (uartDrops != 0xff)
+            ++uartDrops;
+        return 0;
+    }
+    crc = Crc8(dat, num);
+    distPos = uartTxHead;
+    head = (distPos + 1) & TX_MASK;
+    dist = 1;
+    ++num; // 最后一个字节为 CRC
+    do
+    {
+        b = --num ? *dat++ : crc;
+        if (b)
+        {
+            uartTx[head] = b;
+            ++dist;
+        }
+        else
+        {
+            uartTx[distPos] = dist;
+            distPos = head;
+            dist = 1;
+        }
+        head = (head + 1) & TX_MASK;
+    } while (num);
+    uartTx[distPos] = dist;
+    uartTx[head] = 0; // 分隔符
+    uartTxHead = (head + 1) & TX_MASK; // 整帧写好之后才交给中断
+    if (uart_tx_idle)
+    { // 中断已停止 手动触发一次
+        uart_tx_idle = 0;
+        TI = 1;
+    }
+    return 1;
+}
+
+uchar Uart_TxFree(void)
+{
+    return (uartTxTail - uartTxHead - 1) & TX_MASK;
+}
+
+/**
+ * 在串口中断中调用
+ * 开销: 发送一个字节约 20 个机器周期 每秒最多 960 次
+ */
+void Uart_Service(void)
+{
+    uchar i;
+    if (!TI)
+        return;
+    TI = 0;
+    i = uartTxTail;
+    if (i == uartTxHead)
+    {
+        uart_tx_idle = 1;
+        return;
+    }
+    SBUF = uartTx[i];
+    uartTxTail = (i + 1) & TX_MASK;
+}
+
+#endif // UART_TELEMETRY
@@ -6,7 +6,13 @@
  */
 #include "__config__.h"
 #include "at24c02.h"
+#include "control.h"
+#include "diag.h"
+#include "ds18b20.h"
 #include "lcd1602.h"
+#include "lcdfb.h"
+#include "uart.h"
+#include "ultimate.h"
 #include "utility.h"
 
 #define uint unsigned int
@@ -16,20 +22,37 @@
 #define _GROUP_ "      NO.13     "
 #define SETTING_NUM 6
 
-extern uint SHOW_WAIT;
 extern bit page_change;
-extern bit ringtone_change;
+extern bit boot_splash;
+extern uchar bootStep;
+extern uint tickCount, bootWait, decisionTick;
+extern bit music_refill;
 extern char upperLimit, lowerLimit;
-extern float temperature;
-extern float highest, lowest;
+extern int temperature; // 单位 1/16 度
+extern int highest, lowest;
 extern uchar fanGear, fanGearStep;
+extern bit history_changed;
+extern char idata history[];
+extern uchar historyPos;
 extern uchar hus, hms, hs, hm; // 开机后 超过温度上限 时间
 extern uchar lus, lms, ls, lm; // 开机后 低于温度下限 时间
+extern uchar checkpointSeq, checkpointAge;
+extern bit checkpoint_event, checkpoint_dirty;
+extern bit above_upper_limit, below_lower_limit, dc_motor_working;
+#ifdef UART_TELEMETRY
+extern uchar telemetryCount, telemetrySeq;
+#endif
 extern uchar key, pressKey, page, option;
 extern uchar dsr, ringtoneNum, ringRate, changeCount;
 extern uchar numStr[];
 extern uchar code DC[];
-extern uchar idata musicArr[];
+extern uchar freqSelect, musicSel, musicBegin, musicEnd, musicAddr;
+extern uchar noteRepeat;
+extern bit note_dotted;
+extern uchar idata musicBuf[][MUSIC_BUF_SIZE];
+#ifdef EEPROM_IMAGE_LOADER
+extern uchar code eepromImage[];
+#endif
 
 void Delay1ms(uint t) // 12MHz
 {                     // 软件延迟 参数用uchar 比uint 精准
@@ -44,86 +67,175 @@ void Delay1ms(uint t) // 12MHz
 } // (8+1+8*124-2)us * t + ((t/256)+10+6)us 约 t ms
 
 void UpdateExtremes(bit which);
+void UpdateHistory(void);
+void ShowViewPage_1(void);
 
 // ============== LCD1602 ==============
 
 void LCD1602_ShowString(uchar* s)
 {
     while (*s)
-    {
         LCD1602_WriteData(*s++);
-        Delay1ms(SHOW_WAIT);
-    }
 }
 
 void LCD1602_Action(void)
 {
-    uchar i;
-    // 开启 LCD1602 显示 (initial)
+    // 开启 LCD1602 显示 (initial) T0 开始工作前直接写入
     LCD1602_WriteCmd(Set_8bit_2line_5x7);   // 命令6
     LCD1602_WriteCmd(Show_CursorOff);       // 命令4
     LCD1602_WriteCmd(Mode_CursorRightMove); // 命令3
     LCD1602_WriteCmd(Clear_Screen);         // 命令1
+    LcdFb_Reset();                          // 影子显存与屏幕一致
+} // LCD1602 Action
 
-    // 开机界面
-    LCD1602_WriteCmd(Move_Cursor_Row1_Col(16)); // 命令8 设置光标在显示屏之外
-    LCD1602_ShowString(WELCOME);
-    SHOW_WAIT = 200;
-    LCD1602_WriteCmd(Move_Cursor_Row2_Col(16)); // 命令8
-    LCD1602_WriteCmd(Mode_ScreenRightMove);     // 命令3
-    LCD1602_ShowString(_GROUP_); // 一边输出第二行 一边移动屏幕
-    LCD1602_WriteCmd(Mode_CursorRightMove); // 命令3  恢复光标自增
-
-    i = 3;
-    do // 闪烁三次
-    {
-        LCD1602_WriteCmd(Show_ScreenOff); // 命令4
-        Delay1ms(SHOW_WAIT * 2);
-        LCD1602_WriteCmd(Show_CursorOff); // 命令4
-        Delay1ms(SHOW_WAIT * 2);
-    } while (--i);
-    i = 16;
+// ============== 节拍 ==============
+
+uint GetTickCount(void)
+{
+    uint t;
     do
+    { // T0 中断可能在读取两个字节之间修改 读到两次相同为止
+        t = tickCount;
+    } while (t != tickCount);
+    return t;
+}
+
+/**
+ * 开机动画 (在主循环中一步一步执行 期间温度检测与控制照常工作)
+ * 每一步放入写入队列一个字节 然后等待 bootWait 到达
+ * 队列已满时不前进 下次再试
+ *   0- 18: 在屏幕之外写入欢迎语 定位第二行 (屏幕跟随光标移动)
+ *  19- 34: 每 200ms 写入第二行一个字符 屏幕右移
+ *  35- 41: 恢复光标自增 闪烁三次 (每次 400ms)
+ *  42- 57: 每 200ms 屏幕右移一次 字体移出屏幕
+ *  58- 61: 清屏 打开光标 以打字机效果 (每个字符 40ms) 显示主视图 关闭光标
+ */
+#define BOOT_MS(X) ((uint)((X) * 36L / 10)) // 毫秒转为 T0 节拍数
+
+void BootSplash(void)
+{
+    uint t = GetTickCount();
+    uchar step = bootStep;
+    uint wait = 0;
+    if ((int)(t - bootWait) < 0)
+        return;
+    if (step == 0)
     {
-        LCD1602_WriteCmd(Shift_ScreenRight); // 命令5
-        Delay1ms(SHOW_WAIT);
-    } while (--i);                  // 字体移出屏幕
-    LCD1602_WriteCmd(Clear_Screen); // 命令1 清屏
-    SHOW_WAIT = 0;
-} // LCD1602 Action
+        if (!LcdFb_Push(0, Move_Cursor_Row1_Col(16))) // 命令8 设置光标在显示屏之外
+            return;
+    }
+    else if (step <= 16)
+    {
+        if (!LcdFb_Push(1, WELCOME[step - 1]))
+            return;
+    }
+    else if (step == 17)
+    {
+        if (!LcdFb_Push(0, Move_Cursor_Row2_Col(16))) // 命令8
+            return;
+    }
+    else if (step == 18)
+    {
+        if (!LcdFb_Push(0, Mode_ScreenRightMove)) // 命令3
+            return;
+    }
+    else if (step <= 34)
+    { // 一边输出第二行 一边移动屏幕
+        if (!LcdFb_Push(1, _GROUP_[step - 19]))
+            return;
+        wait = BOOT_MS(200);
+    }
+    else if (step == 35)
+    {
+        if (!LcdFb_Push(0, Mode_CursorRightMove)) // 命令3  恢复光标自增
+            return;
+    }
+    else if (step <= 41)
+    { // 闪烁三次
+        if (!LcdFb_Push(0, step & 1 ? Show_CursorOff : Show_ScreenOff)) // 命令4
+            return;
+        wait = BOOT_MS(400);
+    }
+    else if (step <= 57)
+    {
+        if (!LcdFb_Push(0, Shift_ScreenRight)) // 命令5
+            return;
+        wait = BOOT_MS(200);
+    }
+    else if (step == 58)
+    {
+        if (!LcdFb_Push(0, Clear_Screen)) // 命令1 清屏
+            return;
+        LcdFb_Reset();
+        ShowViewPage_1(); // 主视图先写入影子显存
+    }
+    else if (step == 59)
+    {
+        if (!LcdFb_Push(0, Show_CursorOn)) // 打开光标
+            return;
+    }
+    else if (step == 60)
+    { // 开机打字机特效 每次只放入一个字符
+        wait = BOOT_MS(40);
+        if (LcdFb_FlushLimit(1))
+        {
+            bootWait = t + wait;
+            return;
+        }
+    }
+    else
+    {
+        if (!LcdFb_Push(0, Show_CursorOff)) // 关闭光标
+            return;
+        boot_splash = 0;
+        page_change = 1; // 刷新当前视图 (开机期间可能已经切换)
+    }
+    bootStep = step + 1;
+    bootWait = t + wait;
+}
+
+void ShowTemperature(void)
+{
+    if (decisionTick)
+    {
+        Temp16ToString(temperature, numStr, 5);
+        LcdFb_ShowString(numStr);
+    }
+    else
+        LcdFb_ShowString(" --.-"); // 第一次温度转换还未完成
+}
 
 void ShowViewPage_1(void)
 {
     // 第一行 温度上限 温度下限
-    LCD1602_WriteCmd(Clear_Screen); // 命令1 清屏
-    LCD1602_ShowString("H:");
+    LcdFb_Clear();
+    LcdFb_ShowString("H:");
     Int8ToString(upperLimit, numStr, 3);
-    LCD1602_ShowString(numStr);
-    LCD1602_ShowString(DC);
-    LCD1602_ShowString("  L:");
+    LcdFb_ShowString(numStr);
+    LcdFb_ShowString(DC);
+    LcdFb_ShowString("  L:");
     Int8ToString(lowerLimit, numStr, 3);
-    LCD1602_ShowString(numStr);
-    LCD1602_ShowString(DC);
+    LcdFb_ShowString(numStr);
+    LcdFb_ShowString(DC);
     // 第二行 温度 风扇档位
-    LCD1602_WriteCmd(Move_Cursor_Row2_Col(0));
-    LCD1602_ShowString("T:");
-    FloatToString(temperature, numStr, 5, 1);
-    LCD1602_ShowString(numStr);
-    LCD1602_ShowString(DC);
-    LCD1602_ShowString("  FAN:");
+    LcdFb_Cursor(Move_Cursor_Row2_Col(0));
+    LcdFb_ShowString("T:");
+    ShowTemperature();
+    LcdFb_ShowString(DC);
+    LcdFb_ShowString("  FAN:");
     Int8ToString(fanGear, numStr, 1);
-    LCD1602_ShowString(numStr);
+    LcdFb_ShowString(numStr);
 }
 
 void ShowViewPage_2(void)
 {
     // 第一行 自开机后的最高温
-    LCD1602_WriteCmd(Clear_Screen); // 命令1 清屏
-    LCD1602_ShowString("Highest: ");
+    LcdFb_Clear();
+    LcdFb_ShowString("Highest: ");
     UpdateExtremes(1);
     // 第二行 自开机后的最低温
-    LCD1602_WriteCmd(Move_Cursor_Row2_Col(0));
-    LCD1602_ShowString("Lowest:  ");
+    LcdFb_Cursor(Move_Cursor_Row2_Col(0));
+    LcdFb_ShowString("Lowest:  ");
     UpdateExtremes(0);
 }
 
@@ -131,12 +243,12 @@ void ShowViewPage_3(void)
 {
     void UpdateOverLimitTimer(bit which);
     // 第一行 超过温度上限时长
-    LCD1602_WriteCmd(Clear_Screen); // 命令1 清屏
-    LCD1602_ShowString("Above H:");
+    LcdFb_Clear();
+    LcdFb_ShowString("Above H:");
     UpdateOverLimitTimer(1);
     // 第二行 低于温度下限时长
-    LCD1602_WriteCmd(Move_Cursor_Row2_Col(0));
-    LCD1602_ShowString("Below L:");
+    LcdFb_Cursor(Move_Cursor_Row2_Col(0));
+    LcdFb_ShowString("Below L:");
     UpdateOverLimitTimer(0);
 }
 
@@ -144,25 +256,119 @@ void ShowViewPage_4(void)
 {
     char KeysSystem_3(void);
     uchar i;
-    LCD1602_WriteCmd(Clear_Screen); // 命令1 清屏
     // 第一行 温感分辨率 风扇档位步长 (开机音乐?)
-    LCD1602_WriteCmd(Clear_Screen); // 命令1 清屏
-    LCD1602_ShowString("TR: ");
-    LCD1602_WriteData('0' + dsr);
-    LCD1602_ShowString("   FGS: ");
-    LCD1602_WriteData('0' + fanGearStep);
-    LCD1602_ShowString(DC);
+    LcdFb_Clear();
+    LcdFb_ShowString("TR: ");
+    LcdFb_WriteData('0' + dsr);
+    LcdFb_ShowString("   FGS: ");
+    LcdFb_WriteData('0' + fanGearStep);
+    LcdFb_ShowString(DC);
     // 第二行 ring速度
-    LCD1602_WriteCmd(Move_Cursor_Row2_Col(0));
-    LCD1602_ShowString("ringRate:");
+    LcdFb_Cursor(Move_Cursor_Row2_Col(0));
+    LcdFb_ShowString("ringRate:");
     i = 0;
     while (i < ringRate)
     {
-        LCD1602_WriteData(0xff);
+        LcdFb_WriteData(0xff);
         ++i;
     }
 }
 
+void ShowViewPage_5(void)
+{
+    // 第一行 历史温度的范围
+    LcdFb_Clear();
+    LcdFb_ShowString("Hist");
+    // 第二行 16 个采样的柱状曲线 左边最早
+    UpdateHistory();
+}
+
+#ifdef DIAG_ENABLE
+uchar code DiagName[DIAG_VIEW_NUM][3] = {"T0", "T2", "SI", "X0", "ML", "SP"};
+
+void ShowViewPage_6(void)
+{
+    LcdFb_Clear();
+    UpdateDiag();
+}
+
+/**
+ * 诊断视图 (diagView 项)
+ * 中断:   "T0 L 28 E 45-198"  响应延迟最大值 执行时间最小-最大值 (机器周期)
+ *         "n12345 CPU  34%"   次数 (到 65535 回绕) 中断的 CPU 占用
+ * X0:     "X0 max  3601 tk"   长按消抖最长的时间 (节拍)
+ * 主循环: "ML max    12 tk"   一次循环最长的时间
+ *         "D  1234 CPU  34%"  开机到第一次控制决策的节拍
+ * 栈:     "SP base 137     "  开机时的 SP
+ *         "use  40 free  78"  用到的最多字节数 余量
+ */
+void UpdateDiag(void)
+{
+    uchar v = diagView, lat, exMin, exMax, load, peak;
+    uint count, max;
+    if (v == DIAG_STACK)
+    {
+        peak = Diag_StackPeak();
+        LcdFb_Cursor(Move_Cursor_Row1_Col(0));
+        LcdFb_ShowString("SP base ");
+        UIntToString(diagStackBase, numStr, 3);
+        LcdFb_ShowString(numStr);
+        LcdFb_Cursor(Move_Cursor_Row2_Col(0));
+        LcdFb_ShowString("use ");
+        UIntToString(peak - diagStackBase, numStr, 3);
+        LcdFb_ShowString(numStr);
+        LcdFb_ShowString(" free ");
+        UIntToString(0xff - peak, numStr, 3);
+        LcdFb_ShowString(numStr);
+        return;
+    }
+    EA = 0; // 多字节的统计由中断修改 一次复制出来
+    lat = diagLatMax[v < DIAG_SRC_NUM ? v : 0];
+    exMin = diagExMin[v < DIAG_SRC_NUM ? v : 0];
+    exMax = diagExMax[v < DIAG_SRC_NUM ? v : 0];
+    count = v == DIAG_LOOP ? decisionTick : diagCount[v];
+    max = v == DIAG_X0 ? diagX0Max : diagLoopMax;
+    load = diagLoad;
+    EA = 1;
+    // 第一行
+    LcdFb_Cursor(Move_Cursor_Row1_Col(0));
+    LcdFb_ShowString(DiagName[v]);
+    if (v < DIAG_SRC_NUM)
+    {
+        LcdFb_ShowString(" L");
+        if (v == DIAG_UART)
+            LcdFb_ShowString("  -"); // 不知道字节何时收发完成 只有执行时间
+        else
+        {
+            UIntToString(lat, numStr, 3);
+            LcdFb_ShowString(numStr);
+        }
+        LcdFb_ShowString(" E");
+        UIntToString(exMin, numStr, 3);
+        LcdFb_ShowString(numStr);
+        LcdFb_WriteData('-');
+        UIntToString(exMax, numStr, 3);
+        LcdFb_ShowString(numStr);
+    }
+    else
+    {
+        LcdFb_ShowString(" max ");
+        UIntToString(max, numStr, 5);
+        LcdFb_ShowString(numStr);
+        LcdFb_ShowString(" tk ");
+    }
+    // 第二行
+    LcdFb_Cursor(Move_Cursor_Row2_Col(0));
+    LcdFb_WriteData(v == DIAG_LOOP ? 'D' : 'n');
+    UIntToString(count, numStr, 5);
+    LcdFb_ShowString(numStr);
+    LcdFb_ShowString(" CPU ");
+    UIntToString((uint)load * 100 >> 8, numStr, 3);
+    LcdFb_ShowString(numStr);
+    LcdFb_WriteData('%');
+}
+#endif
+
 void ShowSettings(uchar opt)
 {
     bit i;
@@ -315,11 +521,8 @@ void ChangeSetting(void)
             case 2: {
                 if (option == 5)
                     ringRate = i;
-                else if (option == 4 && ringtoneNum != i)
-                {
-                    ringtone_change = 1;
+                else if (option == 4)
                     ringtoneNum = i;
-                }
                 else if (option == 3)
                     fanGearStep = i;
                 else if (option == 2)
@@ -368,10 +571,26 @@ void KeysSystem_1(void)
     key |= KEYS;
     switch (key)
     {
-    case 0x7f: // P37
     case 0xbf: // P36
+        if (page == key)
+        { // 在极值视图再按一次 S2 进入温度历史曲线视图
+            if (CheckKeysInvalid())
+                return;
+            pressKey = 0x3f;
+            break;
+        }
+    case 0x7f: // P37
     case 0xdf: // P35
     case 0xef: // P34
+#ifdef DIAG_ENABLE
+        if (key == 0xef && (page == key || page == 0x2f))
+        { // 在设置查询视图再按一次 S4 进入诊断视图 在诊断视图按 S4 切换下一项
+            if (CheckKeysInvalid())
+                return;
+            pressKey = 0x2f;
+            break;
+        }
+#endif
         if (page == key || CheckKeysInvalid())
             return;
         pressKey = key;
@@ -380,6 +599,10 @@ void KeysSystem_1(void)
         if (pressKey == 0xff || CheckKeysInvalid())
             return;
         page_change = 1;
+#ifdef DIAG_ENABLE
+        if (page == 0x2f && pressKey == 0x2f && ++diagView == DIAG_VIEW_NUM)
+            diagView = 0;
+#endif
         page = pressKey;
     default:
         pressKey = 0xff;
@@ -546,30 +769,371 @@ void UpdateOverLimitTimer(bit which) // 1: Above  0: Below
         Int8ToString(lm, numStr, 2);
         Int8ToString(ls, numStr + 3, 2);
     }
-    LCD1602_ShowString(numStr);
-    LCD1602_ShowString("m");
-    LCD1602_ShowString(numStr + 3);
-    LCD1602_ShowString(".");
+    LcdFb_ShowString(numStr);
+    LcdFb_ShowString("m");
+    LcdFb_ShowString(numStr + 3);
+    LcdFb_ShowString(".");
     if (which)
         Int8ToString(hms >> 1, numStr, 1);
     else
         Int8ToString(lms >> 1, numStr, 1);
-    LCD1602_ShowString(numStr);
-    LCD1602_ShowString("s");
+    LcdFb_ShowString(numStr);
+    LcdFb_ShowString("s");
 }
 
 void UpdateExtremes(bit which) // 1: Highest  0: Lowest
 {
-    FloatToString(which ? highest : lowest, numStr, 5, 1);
-    LCD1602_ShowString(numStr);
-    LCD1602_ShowString(DC);
+    Temp16ToString(which ? highest : lowest, numStr, 5);
+    LcdFb_ShowString(numStr);
+    LcdFb_ShowString(DC);
+}
+
+void AddHistory(void)
+{
+    // 四舍五入到整数度
+    if (temperature < 0)
+        history[historyPos] = -(char)((uint)(8 - temperature) >> 4);
+    else
+        history[historyPos] = (uint)(temperature + 8) >> 4;
+    historyPos = (historyPos + 1) & (HISTORY_SIZE - 1);
+    history_changed = 1;
+}
+
+void InitHistory(void)
+{
+    uchar i = HISTORY_SIZE;
+    do
+    {
+        history[--i] = HISTORY_EMPTY;
+    } while (i);
+    historyPos = 0;
+}
+
+void UpdateHistory(void)
+{
+    uchar i, level;
+    char t, hi = -127, lo = 127;
+    history_changed = 0;
+    // 找出已有采样的范围 纵轴随范围缩放
+    i = HISTORY_SIZE;
+    do
+    {
+        t = history[--i];
+        if (t == HISTORY_EMPTY)
+            continue;
+        if (t > hi)
+            hi = t;
+        if (t < lo)
+            lo = t;
+    } while (i);
+    if (hi < lo)
+        return; // 还没有采样
+    LcdFb_Cursor(Move_Cursor_Row1_Col(5));
+    Int8ToString(lo, numStr, 3);
+    LcdFb_ShowString(numStr);
+    LcdFb_WriteData('~');
+    Int8ToString(hi, numStr, 3);
+    LcdFb_ShowString(numStr);
+    LcdFb_ShowString(DC);
+    // 每个采样 1-8 行高 8 行用 0xff 全黑字符 其余用自定义字符
+    LcdFb_Cursor(Move_Cursor_Row2_Col(0));
+    for (i = 0; i < HISTORY_SIZE; ++i)
+    {
+        t = history[(historyPos + i) & (HISTORY_SIZE - 1)];
+        if (t == HISTORY_EMPTY)
+        {
+            LcdFb_WriteData(' ');
+            continue;
+        }
+        if (hi == lo)
+            level = 4;
+        else
+            level = (uint)(uchar)(t - lo) * 7 / (uchar)(hi - lo) + 1;
+        // 字形已经在 CGRAM 中时 LcdFb_Glyph 只比较一次
+        LcdFb_WriteData(level == 8 ? 0xff : LcdFb_Glyph(level, GLYPH_BAR(level)));
+    }
 }
 
+/**
+ * 约定 (24c02 存储分布见 __config__.h):
+ *   乐谱起始地址表中 后一首的起始地址即为前一首的结尾
+ *   每首歌为压缩后的乐谱 (格式见 __config__.h) 没有结束符
+ * 歌曲不再整首读入内存 而是以两块 MUSIC_BUF_SIZE 字节的缓冲交替播放
+ * 定时器播放完一块后置位 music_refill 由主循环调用 RefillMusic 读取下一块
+ */
+void RefillMusic(void);
+
 void ReadMusic(void)
 {
-    uchar startAddr, musicLen;
-    At24c02_ReadData(0xa0, ringtoneNum + 0x03, &startAddr, 1);
-    At24c02_ReadData(0xa0, ringtoneNum + 0x04, &musicLen, 1);
-    musicLen -= startAddr;
-    At24c02_ReadData(0xa0, startAddr, musicArr, musicLen);
-}
\ No newline at end of file
+    uchar addr[2];
+    At24c02_ReadData(AT24C02_SLA, EE_MUSIC_TABLE + ringtoneNum, addr, 2);
+    musicBegin = addr[0];
+    musicEnd = addr[1];
+    musicAddr = musicBegin;
+    noteRepeat = 0;
+    note_dotted = 0;
+    // 预读两块 从第一块开始播放
+    musicSel = 1;
+    music_refill = 1;
+    RefillMusic();
+    musicSel = 0;
+    music_refill = 1;
+    RefillMusic();
+    freqSelect = 0;
+}
+
+void RefillMusic(void)
+{
+    uchar n, len;
+    uchar idata* p;
+    if (!music_refill)
+        return;
+    p = musicBuf[!musicSel];
+    for (n = MUSIC_BUF_SIZE; n; n -= len)
+    {
+        if (musicBegin >= musicEnd)
+        { // 24c02 中没有这首歌 以休止符填充 避免播放未知数据
+            *p = 0;
+            len = 1;
+        }
+        else
+        { // 连续读 到歌曲结尾时回到开头循环播放
+            len = musicEnd - musicAddr;
+            if (len > n)
+                len = n;
+            At24c02_ReadData(AT24C02_SLA, musicAddr, p, len);
+            musicAddr += len;
+            if (musicAddr == musicEnd)
+                musicAddr = musicBegin;
+        }
+        p += len;
+    }
+    music_refill = 0;
+}
+
+/**
+ * 配置记录: 版本 上限 下限 分辨率 风扇档位步长 铃声序号 铃声速率 CRC 取反
+ * 每项一个字节 增加设置项时改变 CONFIG_VERSION
+ * 两个槽内容相同 提交时先写 A 再写 B 读取时 A 有效用 A 否则用 B
+ * 写 A 中途掉电 B 仍是旧的完整记录 写 B 中途掉电 A 已是新的完整记录
+ */
+#define CFG_VERSION  0
+#define CFG_UPPER    1
+#define CFG_LOWER    2
+#define CFG_DSR      3
+#define CFG_STEP     4
+#define CFG_RINGTONE 5
+#define CFG_RATE     6
+#define CFG_CRC      7
+#define CFG_SIZE     8
+
+bit ReadConfig(uchar addr, uchar* rec)
+{
+    return At24c02_ReadData(AT24C02_SLA, addr, rec, CFG_SIZE) &&
+           rec[CFG_VERSION] == CONFIG_VERSION &&
+           (uchar)~Crc8(rec, CFG_CRC) == rec[CFG_CRC];
+}
+
+// 槽中的内容与 rec 不同才写入 (约 5ms)
+void WriteConfig(uchar addr, uchar* rec)
+{
+    uchar old[CFG_SIZE];
+    uchar i;
+    if (At24c02_ReadData(AT24C02_SLA, addr, old, CFG_SIZE))
+    {
+        for (i = 0; i < CFG_SIZE && old[i] == rec[i]; ++i)
+            ;
+        if (i == CFG_SIZE)
+            return;
+    }
+    At24c02_WriteData(AT24C02_SLA, addr, rec, CFG_SIZE);
+}
+
+void CommitConfig(void)
+{
+    uchar rec[CFG_SIZE];
+    rec[CFG_VERSION] = CONFIG_VERSION;
+    rec[CFG_UPPER] = upperLimit;
+    rec[CFG_LOWER] = lowerLimit;
+    rec[CFG_DSR] = dsr;
+    rec[CFG_STEP] = fanGearStep;
+    rec[CFG_RINGTONE] = ringtoneNum;
+    rec[CFG_RATE] = ringRate;
+    rec[CFG_CRC] = ~Crc8(rec, CFG_CRC);
+    WriteConfig(EE_CONFIG_A, rec);
+    WriteConfig(EE_CONFIG_B, rec);
+}
+
+void LoadConfig(void)
+{
+    uchar rec[CFG_SIZE];
+    if (ReadConfig(EE_CONFIG_A, rec) || ReadConfig(EE_CONFIG_B, rec))
+    {
+        upperLimit = rec[CFG_UPPER];
+        lowerLimit = rec[CFG_LOWER];
+        dsr = rec[CFG_DSR];
+        fanGearStep = rec[CFG_STEP];
+        ringtoneNum = rec[CFG_RINGTONE];
+        ringRate = rec[CFG_RATE];
+        // DS18B20 上电时暂存器为它自己 EEPROM 中的值 写入配置中的分辨率
+        DS18B20_Set(upperLimit, lowerLimit, dsr);
+        return;
+    }
+    // 没有有效的记录 (新的 24c02 或由旧版本升级):
+    // 上下限 分辨率 仍在 DS18B20 中 其余为 0x00 处旧版本的设置 (空白时为镜像中的出厂设置)
+    DS18B20_Get(&upperLimit, &lowerLimit, &dsr);
+    At24c02_ReadData(AT24C02_SLA, EE_SETTINGS, rec, 1);
+#ifdef EEPROM_IMAGE_LOADER
+    if (rec[0] == 0xff)
+        rec[0] = eepromImage[EE_SETTINGS];
+#endif
+    ringRate = rec[0] & 0x07;
+    ringtoneNum = (rec[0] >> 3) & 0x03;
+    fanGearStep = (rec[0] >> 5) & 0x03;
+    CommitConfig();
+}
+
+/**
+ * 极值与越界计时的检查点 (掉电后恢复) 两个槽交替写入 checkpointSeq 最低位选择槽
+ * 记录: 序号 最高温 最低温 上越界 分 秒 下越界 分 秒 CRC 取反
+ * 写入中途掉电只会损坏正在写的槽 另一个槽仍是上一次完整的记录
+ */
+#define CP_SEQ  0
+#define CP_HIGH 1 // 高字节在前
+#define CP_LOW  3
+#define CP_HM   5
+#define CP_HS   6
+#define CP_LM   7
+#define CP_LS   8
+#define CP_CRC  9
+#define CP_SIZE 10
+
+void SaveCheckpoint(void)
+{
+    uchar rec[CP_SIZE];
+    rec[CP_SEQ] = checkpointSeq;
+    rec[CP_HIGH] = highest >> 8;
+    rec[CP_HIGH + 1] = highest & 0xff;
+    rec[CP_LOW] = lowest >> 8;
+    rec[CP_LOW + 1] = lowest & 0xff;
+    EA = 0; // T0 的越界计时可能在读取分和秒之间进位
+    rec[CP_HM] = hm;
+    rec[CP_HS] = hs;
+    rec[CP_LM] = lm;
+    rec[CP_LS] = ls;
+    EA = 1;
+    rec[CP_CRC] = ~Crc8(rec, CP_CRC); // 取反 全 0 的区域不是有效记录
+    At24c02_WriteData(
+        AT24C02_SLA,
+        checkpointSeq & 1 ? EE_CHECKPOINT_B : EE_CHECKPOINT_A,
+        rec,
+        CP_SIZE
+    );
+    ++checkpointSeq;
+    checkpointAge = 0;
+    checkpoint_event = 0;
+    checkpoint_dirty = 0;
+}
+
+void RestoreCheckpoint(void)
+{
+    uchar a[CP_SIZE], b[CP_SIZE];
+    uchar* rec;
+    bit okA, okB;
+    okA = At24c02_ReadData(AT24C02_SLA, EE_CHECKPOINT_A, a, CP_SIZE) &&
+          (uchar)~Crc8(a, CP_CRC) == a[CP_CRC];
+    okB = At24c02_ReadData(AT24C02_SLA, EE_CHECKPOINT_B, b, CP_SIZE) &&
+          (uchar)~Crc8(b, CP_CRC) == b[CP_CRC];
+    if (okA && okB) // 都有效 取序号较新的 (序号回绕 按差值判断)
+        rec = (char)(b[CP_SEQ] - a[CP_SEQ]) > 0 ? b : a;
+    else if (okA)
+        rec = a;
+    else if (okB)
+        rec = b;
+    else
+    { // 新的 24c02 或两个槽都损坏 从槽 A 开始
+        checkpointSeq = 0;
+        return;
+    }
+    highest = (rec[CP_HIGH] << 8) | rec[CP_HIGH + 1];
+    lowest = (rec[CP_LOW] << 8) | rec[CP_LOW + 1];
+    hm = rec[CP_HM];
+    hs = rec[CP_HS];
+    lm = rec[CP_LM];
+    ls = rec[CP_LS];
+    checkpointSeq = rec[CP_SEQ] + 1; // 下一次写入另一个槽
+}
+
+#ifdef EEPROM_IMAGE_LOADER
+/**
+ * 24c02 中的镜像标记与 eepromImage 不同时 按页写入镜像 (每页约 5ms)
+ * 第一次写入 0x03 之后的整个镜像 之后升级镜像版本只写入乐谱 保留控制参数 记录和日志
+ * 0x00 不写入: 旧版本的设置由 LoadConfig 迁移 出厂设置也由它在 0x00 空白时使用
+ * 镜像标记最后写入 中途掉电下次开机会重新写入
+ */
+void LoadEepromImage(void)
+{
+    uchar tag[2];
+    At24c02_ReadData(AT24C02_SLA, EE_IMAGE_TAG, tag, 2);
+    if (tag[0] == eepromImage[EE_IMAGE_TAG] &&
+        tag[1] == eepromImage[EE_IMAGE_TAG + 1])
+        return;
+    if (tag[0] == EE_IMAGE_MAGIC) // 升级
+        At24c02_WriteData(
+            AT24C02_SLA,
+            EE_MUSIC_TABLE,
+            eepromImage + EE_MUSIC_TABLE,
+            EE_CONTROL - EE_MUSIC_TABLE
+        );
+    else // 空白的 24c02 或旧版本 (只有 0x00 的设置和乐谱)
+        At24c02_WriteData(
+            AT24C02_SLA,
+            EE_MUSIC_TABLE,
+            eepromImage + EE_MUSIC_TABLE,
+            0x100 - EE_MUSIC_TABLE
+        );
+    At24c02_WriteData(AT24C02_SLA, EE_IMAGE_TAG, eepromImage + EE_IMAGE_TAG, 2);
+}
+#endif
+
+#ifdef UART_TELEMETRY
+/**
+ * 遥测帧 第一个字节为类型 第二个字节为帧序号 多字节数值高字节在前
+ *   TM_SAMPLE: 温度(1/16 度 2 字节) 风扇档位 占空比(0-64) 状态 丢弃的帧数
+ *     状态: 位0 高于上限 位1 低于下限(继电器闭合) 位2 风扇工作
+ *   TM_EVENT:  事件 温度(1/16 度 2 字节)
+ */
+void Telemetry_Sample(void)
+{
+    uchar frame[8];
+    if (++telemetryCount < TELEMETRY_EVERY)
+        return;
+    telemetryCount = 0;
+    frame[0] = TM_SAMPLE;
+    frame[1] = telemetrySeq++;
+    frame[2] = temperature >> 8;
+    frame[3] = temperature & 0xff;
+    frame[4] = fanGear;
+    frame[5] = ctrlDuty;
+    frame[6] = 0;
+    if (above_upper_limit)
+        frame[6] |= 0x01;
+    if (below_lower_limit)
+        frame[6] |= 0x02;
+    if (dc_motor_working)
+        frame[6] |= 0x04;
+    frame[7] = uartDrops;
+    Uart_SendFrame(frame, 8);
+}
+
+void Telemetry_Event(uchar ev)
+{
+    uchar frame[5];
+    frame[0] = TM_EVENT;
+    frame[1] = telemetrySeq++;
+    frame[2] = ev;
+    frame[3] = temperature >> 8;
+    frame[4] = temperature & 0xff;
+    Uart_SendFrame(frame, 5);
+}
+#endif
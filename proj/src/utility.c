@@ -6,91 +6,100 @@
  * 不加入结束符就可以插入别的字符串中间
  * 但是对于单独开空间存储的来说 要么不同长度各自开空间 要么手动加结束符
  * 所以出于妥协 添加一个宏来作为编译的这一份代码是否需要自动加入结束符
+ * ----------------------------------------------
+ * 只用整数运算: 温度以 DS18B20 的原始值 (1/16 度) 保存 不再使用浮点数
+ * 原来的 FloatToString 每次显示都要做多次浮点乘法和浮点转整数
  */
+#ifdef __C51__
+#include "__config__.h" // DIAG_ENABLE (在主机上编译时不需要)
+#else // 在主机上编译 (tools/fmtcheck)
+#define bit unsigned char
+#define code
+#endif
+
 #define uchar unsigned char
 #define uint unsigned int
 
 #define _ADD_END_
 
 /**
- * @param num 需要转换的数字
+ * 整数除以 10 (减法计数 不调用有符号除法的库函数)
+ * 先减 50 再减 10 最多 5 + 4 次循环
+ */
+#define DIV10(n, q)           \
+    do                        \
+    {                         \
+        q = 0;                \
+        while (n >= 50)       \
+        {                     \
+            n -= 50;          \
+            q += 5;           \
+        }                     \
+        while (n >= 10)       \
+        {                     \
+            n -= 10;          \
+            ++q;              \
+        }                     \
+    } while (0) // 结束后 n 为余数 q 为商
+
+// x/16 加 0.04 后的十分位 (与浮点版本保留 1 位小数的 五舍六入 一致)
+uchar code Tenths16[16] = {0, 1, 1, 2, 2, 3, 4, 4, 5, 6, 6, 7, 7, 8, 9, 9};
+
+/**
+ * 以 1/16 为单位的定点数 (DS18B20 的原始温度值) 转为保留 1 位小数的字符串
+ * 结果与 FloatToString(num / 16.0, str, length, 1) 相同 (原来的浮点版本)
+ * @param num 需要转换的数字 单位 1/16
  * @param str 存储字符串的首地址
- * @param length 转换后数字可以存放的空间长度
- * @param decimal 小数占多少位
+ * @param length 转换后数字可以存放的空间长度 (至少 3 负数至少 4)
  */
-#include <stdio.h>
-void FloatToString(float num, uchar* str, uchar length, uchar decimal)
+void Temp16ToString(int num, uchar* str, uchar length)
 {
-    char i, mid;
-    uint intn, decn;
-    float dec, std;
+    char i;
+    uchar intn, d;
+    bit neg;
 
 #ifdef _ADD_END_
     str[length] = 0; // 字符串结束标志位
 #endif
 
-    std = 0.4;
-    // 确定小数点的位置
-    if (decimal != 0)
-    {
-        if (decimal + (num < 0) + 1 > length)
-        {
-            mid = num < 0;
-            decimal = length - 1 - (num < 0);
-        }
-        else
-            mid = length - decimal - 1;
-        str[mid] = '.';
-    }
-    else
-        mid = length;
-
-    // 五舍六入
-    i = decimal;
-    while (i--)
-        std *= 0.1;
-
-    // 分离整数和小数部分
-    if (num < 0)
-    {
-        num -= std;
-        intn = -(int)num;
-        dec = (int)num - num;
-    }
-    else
-    {
-        num += std;
-        intn = (int)num;
-        dec = num - intn;
-    }
-
-    // 处理小数部分
-    for (i = mid + 1; i < length; ++i)
-    {
-        dec *= 10;
-        decn = (uchar)dec;
-        str[i] = decn + '0';
-        dec -= decn;
-    }
-    // 处理整数部分
-    for (i = mid - 1; i > 0; --i)
+    neg = num < 0;
+    if (neg)
+        num = -num;
+    // 小数部分 查表
+    i = length - 1;
+    str[(uchar)i] = Tenths16[(uchar)num & 0x0f] + '0';
+    str[(uchar)--i] = '.';
+    // 处理整数部分 (-55 - 125 度 不超过 uchar)
+    intn = (uint)num >> 4;
+    for (--i; i > 0; --i)
     {
-        str[i] = intn % 10 + '0';
-        intn /= 10;
+        d = intn;
+        DIV10(d, intn);
+        str[(uchar)i] = d + '0';
         if (intn == 0)
         {
             --i;
             break;
         }
     }
-    str[i] = num < 0 ? '-' : (intn == 0 && mid != 1 ? ' ' : intn % 10 + '0');
+    if (neg)
+        str[(uchar)i] = '-';
+    else if (intn == 0 && length != 3)
+        str[(uchar)i] = ' ';
+    else
+    {
+        while (intn >= 10)
+            intn -= 10;
+        str[(uchar)i] = intn + '0';
+    }
     while (i-- > 0)
-        str[i] = ' ';
+        str[(uchar)i] = ' ';
 }
 
 void Int8ToString(char num, uchar* str, uchar length)
 {
     bit neg;
+    uchar n, q;
 
 #ifdef _ADD_END_
     str[length] = 0; // 字符串结束标志位
@@ -104,16 +113,19 @@ void Int8ToString(char num, uchar* str, uchar length)
         if (!--length)
             return;
         ++str;
-        num = ~num;
-        ++num;
+        n = -num;
     }
-    str[--length] = num % 10 + '0';
+    else
+        n = num;
+    DIV10(n, q);
+    str[--length] = n + '0';
     while (length)
     {
-        num /= 10;
-        if (!num)
+        if (!q)
             break;
-        str[--length] = num % 10 + '0';
+        n = q;
+        DIV10(n, q);
+        str[--length] = n + '0';
     }
     if (neg)
     {
@@ -125,3 +137,47 @@ void Int8ToString(char num, uchar* str, uchar length)
     while (length)
         str[--length] = ' ';
 }
+
+#ifdef DIAG_ENABLE
+/**
+ * 无符号 16 位整数转为右对齐的字符串 (只用于诊断视图 除法调用库函数)
+ * @param length 可以存放的空间长度 数字更长时只保留低位
+ */
+void UIntToString(uint num, uchar* str, uchar length)
+{
+#ifdef _ADD_END_
+    str[length] = 0; // 字符串结束标志位
+#endif
+    while (length)
+    {
+        str[--length] = num % 10 + '0';
+        num /= 10;
+        if (!num)
+            break;
+    }
+    while (length)
+        str[--length] = ' ';
+}
+#endif
+
+/**
+ * CRC-8 (多项式 x^8 + x^5 + x^4 + 1 与 DS18B20 ROM/暂存器相同) 按位计算 不用查表
+ * 每字节约 8 * 10 个机器周期 只用于 24c02 中的记录 不在中断中调用
+ */
+uchar Crc8(uchar* dat, uchar num)
+{
+    uchar crc = 0, b, i;
+    while (num--)
+    {
+        b = *dat++;
+        for (i = 8; i; --i)
+        {
+            if ((crc ^ b) & 0x01)
+                crc = (crc >> 1) ^ 0x8c;
+            else
+                crc >>= 1;
+            b >>= 1;
+        }
+    }
+    return crc;
+}
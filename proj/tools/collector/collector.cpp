@@ -0,0 +1,692 @@
+/**
+ * collector.cpp
+ * ----------------------------------------------
+ * 主机端工具: 同时接收多块板子的串口遥测 (固件定义 UART_TELEMETRY)
+ * 按列存储到一个文件中 也可以生成模拟设备测试吞吐量
+ *
+ * 编译: g++ -std=c++17 -O2 -pthread -o collector collector.cpp
+ * 用法:
+ *   collector [-o out.tcol] [-t 线程数] /dev/ttyUSB0 /dev/ttyUSB1 ...
+ *       接收 直到 Ctrl-C 每个串口 9600 8N1
+ *   collector -b 设备数 [-s 秒] [-t 线程数] [-o out.tcol]
+ *       基准测试: 每个模拟设备一对 pty 生成线程尽快写入随机的帧
+ *       输出每个接收线程的 帧/秒 以及按 CPU 时间折算的 帧/秒/核
+ *   collector -d out.tcol
+ *       读取列存储文件 输出统计
+ *
+ * 帧格式见固件 uart.h 与 ultimate.c 中 Telemetry_Sample:
+ *   COBS(数据 + CRC-8/MAXIM) + 0x00 数据第一个字节为类型 第二个为帧序号
+ *
+ * 接收: 每个串口一个环形缓冲 read 直接读入缓冲的空闲部分
+ *   找到 0x00 后原地 COBS 解码 (解码结果不会比编码长) 校验 CRC 后追加到列
+ *   只有跨过缓冲末尾的帧复制到栈上的临时区 (最长 255 字节) 没有按帧分配内存
+ * 列存储文件 (小端):
+ *   文件头  "TCOL" u32 版本(1)
+ *   块      u32 类型 ('S' 采样 'E' 事件) u32 行数 n 之后每列 n 个值连续存放
+ *   采样块  u64 时间(us) u16 设备 u8 序号 i16 温度(1/16 度) u8 档位 u8 占空比 u8 状态 u8 丢帧
+ *   事件块  u64 时间(us) u16 设备 u8 序号 u8 事件 i16 温度(1/16 度)
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <poll.h>
+#include <random>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/uio.h>
+#include <termios.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+// 与固件 ultimate.h 保持一致
+constexpr uint8_t TM_SAMPLE = 0x01;
+constexpr uint8_t TM_EVENT = 0x02;
+constexpr size_t SAMPLE_LEN = 8; // 不含 CRC
+constexpr size_t EVENT_LEN = 5;
+
+constexpr size_t RING_SIZE = 1 << 16;  // 每个串口的接收缓冲 (2 的幂)
+constexpr size_t FRAME_MAX = 255;      // 固件的帧远小于此
+constexpr size_t BLOCK_ROWS = 1 << 14; // 每块的行数
+constexpr uint32_t FILE_VERSION = 1;
+
+std::atomic<bool> gStop{false};
+
+uint8_t Crc8(const uint8_t* p, size_t n)
+{
+    uint8_t crc = 0;
+    while (n--)
+    {
+        uint8_t b = *p++;
+        for (int i = 0; i < 8; ++i)
+        {
+            crc = ((crc ^ b) & 1) ? (crc >> 1) ^ 0x8c : crc >> 1;
+            b >>= 1;
+        }
+    }
+    return crc;
+}
+
+// 原地解码 返回解码后的长度 格式错误返回 -1
+int CobsDecode(uint8_t* p, size_t n)
+{
+    size_t in = 0, out = 0;
+    while (in < n)
+    {
+        uint8_t dist = p[in++];
+        if (!dist || in + dist - 1 > n)
+            return -1;
+        for (uint8_t i = 1; i < dist; ++i)
+            p[out++] = p[in++];
+        if (dist != 0xff && in < n)
+            p[out++] = 0;
+    }
+    return static_cast<int>(out);
+}
+
+// 编码 (模拟设备使用) 追加到 out
+void CobsEncode(const uint8_t* p, size_t n, std::vector<uint8_t>& out)
+{
+    size_t distPos = out.size();
+    out.push_back(0);
+    uint8_t dist = 1;
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (p[i])
+        {
+            out.push_back(p[i]);
+            ++dist;
+        }
+        else
+        {
+            out[distPos] = dist;
+            distPos = out.size();
+            out.push_back(0);
+            dist = 1;
+        }
+    }
+    out[distPos] = dist;
+    out.push_back(0);
+}
+
+uint64_t NowUs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return uint64_t(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+double ThreadCpuSeconds()
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// ----------------------------- 列存储 -----------------------------
+
+class ColumnFile
+{
+public:
+    bool Open(const std::string& path)
+    {
+        fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd_ < 0)
+            return false;
+        char head[8] = {'T', 'C', 'O', 'L'};
+        std::memcpy(head + 4, &FILE_VERSION, 4);
+        return ::write(fd_, head, 8) == 8;
+    }
+    ~ColumnFile()
+    {
+        if (fd_ >= 0)
+            ::close(fd_);
+    }
+    bool Enabled() const { return fd_ >= 0; }
+
+    // 一个块的所有列一次写入 多个接收线程共用 块之间互斥
+    void WriteBlock(uint32_t type, uint32_t rows, iovec* cols, int ncols)
+    {
+        if (fd_ < 0 || !rows)
+            return;
+        uint32_t head[2] = {type, rows};
+        std::vector<iovec> iov;
+        iov.reserve(ncols + 1);
+        iov.push_back({head, sizeof head});
+        iov.insert(iov.end(), cols, cols + ncols);
+        std::lock_guard<std::mutex> lock(mu_);
+        if (::writev(fd_, iov.data(), static_cast<int>(iov.size())) < 0)
+            std::perror("collector: write");
+    }
+
+private:
+    int fd_ = -1;
+    std::mutex mu_;
+};
+
+// 每个接收线程一份 预先分配 写满一块后写入文件
+struct SampleColumns
+{
+    std::unique_ptr<uint64_t[]> time{new uint64_t[BLOCK_ROWS]};
+    std::unique_ptr<uint16_t[]> dev{new uint16_t[BLOCK_ROWS]};
+    std::unique_ptr<uint8_t[]> seq{new uint8_t[BLOCK_ROWS]};
+    std::unique_ptr<int16_t[]> temp{new int16_t[BLOCK_ROWS]};
+    std::unique_ptr<uint8_t[]> gear{new uint8_t[BLOCK_ROWS]};
+    std::unique_ptr<uint8_t[]> duty{new uint8_t[BLOCK_ROWS]};
+    std::unique_ptr<uint8_t[]> flags{new uint8_t[BLOCK_ROWS]};
+    std::unique_ptr<uint8_t[]> drops{new uint8_t[BLOCK_ROWS]};
+    uint32_t rows = 0;
+
+    void Flush(ColumnFile& file)
+    {
+        iovec cols[] = {
+            {time.get(), rows * sizeof(uint64_t)}, {dev.get(), rows * sizeof(uint16_t)},
+            {seq.get(), rows},                      {temp.get(), rows * sizeof(int16_t)},
+            {gear.get(), rows},                     {duty.get(), rows},
+            {flags.get(), rows},                    {drops.get(), rows},
+        };
+        file.WriteBlock('S', rows, cols, 8);
+        rows = 0;
+    }
+};
+
+struct EventColumns
+{
+    std::unique_ptr<uint64_t[]> time{new uint64_t[BLOCK_ROWS]};
+    std::unique_ptr<uint16_t[]> dev{new uint16_t[BLOCK_ROWS]};
+    std::unique_ptr<uint8_t[]> seq{new uint8_t[BLOCK_ROWS]};
+    std::unique_ptr<uint8_t[]> event{new uint8_t[BLOCK_ROWS]};
+    std::unique_ptr<int16_t[]> temp{new int16_t[BLOCK_ROWS]};
+    uint32_t rows = 0;
+
+    void Flush(ColumnFile& file)
+    {
+        iovec cols[] = {
+            {time.get(), rows * sizeof(uint64_t)}, {dev.get(), rows * sizeof(uint16_t)},
+            {seq.get(), rows},                      {event.get(), rows},
+            {temp.get(), rows * sizeof(int16_t)},
+        };
+        file.WriteBlock('E', rows, cols, 5);
+        rows = 0;
+    }
+};
+
+// ----------------------------- 接收 -----------------------------
+
+struct PortStats
+{
+    uint64_t bytes = 0, frames = 0, crcErrors = 0, badFrames = 0, seqGaps = 0, overruns = 0;
+};
+
+struct Port
+{
+    int fd = -1;
+    uint16_t dev = 0;
+    std::string name;
+    std::unique_ptr<uint8_t[]> ring{new uint8_t[RING_SIZE]};
+    uint64_t head = 0, tail = 0, scan = 0; // 单调增加 & (RING_SIZE - 1) 为位置
+    int lastSeq = -1;
+    PortStats stats;
+};
+
+class Receiver
+{
+public:
+    Receiver(ColumnFile& file) : file_(file) {}
+
+    void Add(Port* port) { ports_.push_back(port); }
+
+    void Run()
+    {
+        int ep = epoll_create1(0);
+        for (Port* p : ports_)
+        {
+            epoll_event ev{};
+            ev.events = EPOLLIN;
+            ev.data.ptr = p;
+            epoll_ctl(ep, EPOLL_CTL_ADD, p->fd, &ev);
+        }
+        epoll_event evs[64];
+        double cpu0 = ThreadCpuSeconds();
+        while (!gStop.load(std::memory_order_relaxed))
+        {
+            int n = epoll_wait(ep, evs, 64, 100);
+            for (int i = 0; i < n; ++i)
+                Drain(*static_cast<Port*>(evs[i].data.ptr));
+        }
+        for (Port* p : ports_)
+            Drain(*p);
+        cpuSeconds = ThreadCpuSeconds() - cpu0;
+        samples_.Flush(file_);
+        events_.Flush(file_);
+        ::close(ep);
+    }
+
+    double cpuSeconds = 0;
+
+private:
+    void Drain(Port& p)
+    {
+        for (;;)
+        {
+            uint64_t used = p.head - p.tail;
+            if (used == RING_SIZE)
+            { // 整个缓冲中没有分隔符 丢弃重新同步
+                ++p.stats.overruns;
+                p.tail = p.scan = p.head;
+                used = 0;
+            }
+            size_t pos = p.head & (RING_SIZE - 1);
+            size_t room = std::min<size_t>(RING_SIZE - used, RING_SIZE - pos);
+            ssize_t got = ::read(p.fd, p.ring.get() + pos, room);
+            if (got <= 0)
+                return;
+            p.head += got;
+            p.stats.bytes += got;
+            Scan(p);
+        }
+    }
+
+    void Scan(Port& p)
+    {
+        uint8_t* ring = p.ring.get();
+        for (; p.scan < p.head; ++p.scan)
+        {
+            if (ring[p.scan & (RING_SIZE - 1)])
+                continue;
+            uint64_t len = p.scan - p.tail;
+            size_t start = p.tail & (RING_SIZE - 1);
+            p.tail = p.scan + 1;
+            if (!len)
+                continue; // 连续的分隔符
+            if (len > FRAME_MAX)
+            {
+                ++p.stats.badFrames;
+                continue;
+            }
+            uint8_t scratch[FRAME_MAX];
+            uint8_t* f = ring + start;
+            if (start + len > RING_SIZE)
+            { // 跨过缓冲末尾 复制到临时区
+                size_t first = RING_SIZE - start;
+                std::memcpy(scratch, f, first);
+                std::memcpy(scratch + first, ring, len - first);
+                f = scratch;
+            }
+            Frame(p, f, static_cast<size_t>(len));
+        }
+    }
+
+    void Frame(Port& p, uint8_t* f, size_t len)
+    {
+        int n = CobsDecode(f, len);
+        if (n < 3)
+        {
+            ++p.stats.badFrames;
+            return;
+        }
+        if (Crc8(f, n - 1) != f[n - 1])
+        {
+            ++p.stats.crcErrors;
+            return;
+        }
+        --n;
+        uint8_t seq = f[1];
+        if (p.lastSeq >= 0 && seq != uint8_t(p.lastSeq + 1))
+            ++p.stats.seqGaps;
+        p.lastSeq = seq;
+        ++p.stats.frames;
+        if (!file_.Enabled())
+            return;
+        uint64_t now = NowUs();
+        if (f[0] == TM_SAMPLE && n == SAMPLE_LEN)
+        {
+            SampleColumns& c = samples_;
+            uint32_t r = c.rows;
+            c.time[r] = now;
+            c.dev[r] = p.dev;
+            c.seq[r] = seq;
+            c.temp[r] = int16_t(f[2] << 8 | f[3]);
+            c.gear[r] = f[4];
+            c.duty[r] = f[5];
+            c.flags[r] = f[6];
+            c.drops[r] = f[7];
+            if (++c.rows == BLOCK_ROWS)
+                c.Flush(file_);
+        }
+        else if (f[0] == TM_EVENT && n == EVENT_LEN)
+        {
+            EventColumns& c = events_;
+            uint32_t r = c.rows;
+            c.time[r] = now;
+            c.dev[r] = p.dev;
+            c.seq[r] = seq;
+            c.event[r] = f[2];
+            c.temp[r] = int16_t(f[3] << 8 | f[4]);
+            if (++c.rows == BLOCK_ROWS)
+                c.Flush(file_);
+        }
+        else
+            ++p.stats.badFrames;
+    }
+
+    ColumnFile& file_;
+    std::vector<Port*> ports_;
+    SampleColumns samples_;
+    EventColumns events_;
+};
+
+bool OpenTty(Port& p)
+{
+    p.fd = ::open(p.name.c_str(), O_RDONLY | O_NOCTTY | O_NONBLOCK);
+    if (p.fd < 0)
+        return false;
+    termios tio{};
+    if (tcgetattr(p.fd, &tio) == 0)
+    {
+        cfmakeraw(&tio);
+        cfsetispeed(&tio, B9600);
+        cfsetospeed(&tio, B9600);
+        tio.c_cflag |= CLOCAL | CREAD;
+        tcsetattr(p.fd, TCSANOW, &tio);
+    }
+    return true;
+}
+
+// ----------------------------- 模拟设备 -----------------------------
+
+// 一个模拟设备: 预先生成一段帧 (采样为主 夹杂事件 偶尔一个损坏的字节) 循环写入 pty
+void Device(int fd, unsigned id, std::atomic<uint64_t>& sent)
+{
+    std::mt19937 rng(id);
+    std::vector<uint8_t> stream;
+    uint8_t seq = 0;
+    int temp = 25 * 16;
+    uint64_t frames = 0;
+    for (int i = 0; i < 4096; ++i)
+    {
+        uint8_t f[SAMPLE_LEN + 1];
+        size_t n;
+        temp += int(rng() % 5) - 2;
+        if (rng() % 16)
+        {
+            f[0] = TM_SAMPLE;
+            f[1] = seq++;
+            f[2] = uint8_t(temp >> 8);
+            f[3] = uint8_t(temp);
+            f[4] = uint8_t(rng() % 4);
+            f[5] = uint8_t(rng() % 65);
+            f[6] = uint8_t(rng() % 8);
+            f[7] = 0;
+            n = SAMPLE_LEN;
+        }
+        else
+        {
+            f[0] = TM_EVENT;
+            f[1] = seq++;
+            f[2] = uint8_t(rng() % 6);
+            f[3] = uint8_t(temp >> 8);
+            f[4] = uint8_t(temp);
+            n = EVENT_LEN;
+        }
+        f[n] = Crc8(f, n);
+        size_t at = stream.size();
+        CobsEncode(f, n + 1, stream);
+        if (rng() % 1024 == 0)
+        { // 线路干扰 改变一个字节 (不产生 0x00) 接收端应报告 CRC 错误
+            uint8_t& b = stream[at + 2 + rng() % (n - 1)];
+            b = (b ^ 0x10) ? b ^ 0x10 : 0x10;
+        }
+    }
+    // 4096 帧的序号正好回绕 循环写入时序号连续
+    size_t off = 0;
+    while (!gStop.load(std::memory_order_relaxed))
+    {
+        ssize_t w = ::write(fd, stream.data() + off, stream.size() - off);
+        if (w > 0)
+        {
+            off += w;
+            if (off == stream.size())
+            {
+                off = 0;
+                frames += 4096;
+            }
+        }
+        else
+        {
+            pollfd pfd{fd, POLLOUT, 0};
+            ::poll(&pfd, 1, 50);
+        }
+    }
+    sent += frames;
+}
+
+int OpenPty(int& slave)
+{
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) || unlockpt(master))
+        return -1;
+    slave = ::open(ptsname(master), O_RDONLY | O_NOCTTY | O_NONBLOCK);
+    if (slave < 0)
+        return -1;
+    termios tio{};
+    tcgetattr(slave, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(slave, TCSANOW, &tio);
+    fcntl(master, F_SETFL, O_NONBLOCK);
+    return master;
+}
+
+// ----------------------------- 读取列存储文件 -----------------------------
+
+int Dump(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    char head[8];
+    if (!in.read(head, 8) || std::memcmp(head, "TCOL", 4))
+    {
+        std::cerr << path << ": not a collector file\n";
+        return 1;
+    }
+    uint64_t samples = 0, events = 0, blocks = 0;
+    uint64_t tMin = UINT64_MAX, tMax = 0;
+    int tempMin = INT32_MAX, tempMax = INT32_MIN;
+    uint32_t bh[2];
+    std::vector<char> buf;
+    while (in.read(reinterpret_cast<char*>(bh), sizeof bh))
+    {
+        size_t rowBytes = bh[0] == 'S' ? 8 + 2 + 1 + 2 + 4 : 8 + 2 + 1 + 1 + 2;
+        buf.resize(size_t(bh[1]) * rowBytes);
+        if (!in.read(buf.data(), buf.size()))
+        {
+            std::cerr << path << ": truncated block\n";
+            return 1;
+        }
+        ++blocks;
+        const uint64_t* time = reinterpret_cast<const uint64_t*>(buf.data());
+        for (uint32_t i = 0; i < bh[1]; ++i)
+        {
+            tMin = std::min(tMin, time[i]);
+            tMax = std::max(tMax, time[i]);
+        }
+        if (bh[0] == 'S')
+        {
+            samples += bh[1];
+            // 温度列在 时间 设备 序号 之后
+            const char* col = buf.data() + bh[1] * (8 + 2 + 1);
+            for (uint32_t i = 0; i < bh[1]; ++i)
+            {
+                int16_t t;
+                std::memcpy(&t, col + i * 2, 2);
+                tempMin = std::min<int>(tempMin, t);
+                tempMax = std::max<int>(tempMax, t);
+            }
+        }
+        else
+            events += bh[1];
+    }
+    std::printf("%llu blocks, %llu samples, %llu events, %.1f s",
+                (unsigned long long)blocks, (unsigned long long)samples,
+                (unsigned long long)events, samples + events ? (tMax - tMin) / 1e6 : 0.0);
+    if (samples)
+        std::printf(", temperature %.2f .. %.2f C", tempMin / 16.0, tempMax / 16.0);
+    std::printf("\n");
+    return 0;
+}
+
+void Usage()
+{
+    std::cerr << "usage: collector [-o out.tcol] [-t threads] tty...\n"
+                 "       collector -b devices [-s seconds] [-t threads] [-o out.tcol]\n"
+                 "       collector -d file.tcol\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::string outPath, dumpPath;
+    unsigned threads = 1, bench = 0;
+    double seconds = 5;
+    std::vector<std::string> ttys;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string a = argv[i];
+        if (a == "-o" && i + 1 < argc)
+            outPath = argv[++i];
+        else if (a == "-t" && i + 1 < argc)
+            threads = std::max(1, std::atoi(argv[++i]));
+        else if (a == "-b" && i + 1 < argc)
+            bench = std::max(1, std::atoi(argv[++i]));
+        else if (a == "-s" && i + 1 < argc)
+            seconds = std::atof(argv[++i]);
+        else if (a == "-d" && i + 1 < argc)
+            dumpPath = argv[++i];
+        else if (a[0] != '-')
+            ttys.push_back(a);
+        else
+        {
+            Usage();
+            return 2;
+        }
+    }
+    if (!dumpPath.empty())
+        return Dump(dumpPath);
+    if (ttys.empty() == !bench || seconds <= 0)
+    {
+        Usage();
+        return 2;
+    }
+
+    ColumnFile file;
+    if (!outPath.empty() && !file.Open(outPath))
+    {
+        std::perror(outPath.c_str());
+        return 1;
+    }
+
+    std::vector<std::unique_ptr<Port>> ports;
+    std::vector<int> masters;
+    unsigned n = bench ? bench : unsigned(ttys.size());
+    for (unsigned i = 0; i < n; ++i)
+    {
+        auto p = std::make_unique<Port>();
+        p->dev = uint16_t(i);
+        if (bench)
+        {
+            int master = OpenPty(p->fd);
+            if (master < 0)
+            {
+                std::perror("collector: pty");
+                return 1;
+            }
+            masters.push_back(master);
+            p->name = "pty" + std::to_string(i);
+        }
+        else
+        {
+            p->name = ttys[i];
+            if (!OpenTty(*p))
+            {
+                std::perror(p->name.c_str());
+                return 1;
+            }
+        }
+        ports.push_back(std::move(p));
+    }
+
+    // 串口平均分给接收线程 每个线程一个 epoll
+    threads = std::min(threads, n);
+    std::vector<std::unique_ptr<Receiver>> receivers;
+    for (unsigned t = 0; t < threads; ++t)
+        receivers.push_back(std::make_unique<Receiver>(file));
+    for (unsigned i = 0; i < n; ++i)
+        receivers[i % threads]->Add(ports[i].get());
+
+    std::signal(SIGINT, [](int) { gStop = true; });
+    std::signal(SIGTERM, [](int) { gStop = true; });
+
+    std::atomic<uint64_t> sent{0};
+    std::vector<std::thread> pool;
+    for (auto& r : receivers)
+        pool.emplace_back([&r] { r->Run(); });
+    for (unsigned i = 0; i < masters.size(); ++i)
+        pool.emplace_back(Device, masters[i], i, std::ref(sent));
+
+    auto begin = std::chrono::steady_clock::now();
+    if (bench)
+    {
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        gStop = true;
+    }
+    for (auto& th : pool)
+        th.join();
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    PortStats total;
+    for (auto& p : ports)
+    {
+        const PortStats& s = p->stats;
+        if (!bench || ports.size() <= 8)
+            std::printf("%-12s %10llu bytes %9llu frames %5llu crc %5llu bad %5llu gaps %3llu overruns\n",
+                        p->name.c_str(), (unsigned long long)s.bytes,
+                        (unsigned long long)s.frames, (unsigned long long)s.crcErrors,
+                        (unsigned long long)s.badFrames, (unsigned long long)s.seqGaps,
+                        (unsigned long long)s.overruns);
+        total.bytes += s.bytes;
+        total.frames += s.frames;
+        total.crcErrors += s.crcErrors;
+        total.badFrames += s.badFrames;
+        total.seqGaps += s.seqGaps;
+    }
+    double cpu = 0;
+    for (auto& r : receivers)
+        cpu += r->cpuSeconds;
+    std::printf("%u ports, %u threads: %llu frames in %.2f s = %.0f frames/s, "
+                "%.0f frames/s per core (%.2f cpu s), %llu crc, %llu bad, %llu gaps\n",
+                n, threads, (unsigned long long)total.frames, wall, total.frames / wall,
+                cpu > 0 ? total.frames / cpu : 0.0, cpu, (unsigned long long)total.crcErrors,
+                (unsigned long long)total.badFrames, (unsigned long long)total.seqGaps);
+    if (bench)
+        // 一块板子每次温度转换一个采样帧 最快 (分辨率 0) 约 10.7 帧/秒
+        std::printf("=> one core keeps up with about %.0f boards at 10.7 frames/s each\n",
+                    cpu > 0 ? total.frames / cpu / 10.7 : 0.0);
+    for (int m : masters)
+        ::close(m);
+    for (auto& p : ports)
+        ::close(p->fd);
+    return 0;
+}
@@ -0,0 +1,379 @@
+/**
+ * eepromc.cpp
+ * ----------------------------------------------
+ * 主机端工具: 将乐谱 设置编译为 24c02 的 256 字节镜像
+ * 取代之前单独烧录一次的存歌程序 (proj_keil5_music)
+ *
+ * 编译: g++ -std=c++17 -O2 -o eepromc eepromc.cpp
+ * 用法: eepromc songs.txt [-c eeprom_image.c] [-b image.bin] [-x image.hex]
+ *   -c 生成主程序使用的 C 文件 (主程序开机时按页写入 24c02)
+ *   -b 原始二进制镜像
+ *   -x Intel HEX 镜像 (可以直接用编程器烧写 24c02)
+ *
+ * 乐谱文件格式:
+ *   # 注释
+ *   [settings]                 出厂设置 放在 0x00 (开机时不写入 没有配置记录且 0x00 空白时 LoadConfig 使用)
+ *   fanGearStep = 2            0-3
+ *   ringtoneNum = 1            0-3
+ *   ringRate = 6               0-7
+ *   version = 1                镜像版本 改变后主程序会重新写入乐谱
+ *   [control]                  控制参数 写入 EE_CONTROL (control.h 中 ctrlParam 的顺序)
+ *   mode = 0                   0 比例  1 比例积分
+ *   hystHigh = 16              上限回差 单位 1/16 度 (0~80)
+ *   hystLow = 16               下限回差 单位 1/16 度 (0~80)
+ *   kp = 16                    每超过 1 度 增加 kp 级占空比 (共 64 级 0~64)
+ *   ki = 4                     每个采样 每超过 1 度 增加 ki/16 级占空比 (0~64)
+ *   (控制参数只在空白的 24c02 上写入 升级镜像时保留已有的值)
+ *   [song 名字]                最多4首 按顺序编号 0-3
+ *   H1,1, H2,1, M7,1, P,2 ...  音符,时值 与之前 music.c 中的写法相同
+ *
+ * 存储分布与压缩格式见 __config__.h
+ */
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 与 __config__.h 保持一致
+constexpr int EE_SIZE = 256;
+constexpr int EE_SETTINGS = 0x00;
+constexpr int EE_IMAGE_TAG = 0x01;
+constexpr int EE_MUSIC_TABLE = 0x03;
+constexpr int EE_MUSIC = 0x08;
+constexpr int EE_CONTROL = 0x90;
+constexpr int EE_RESERVED = 0x95;
+constexpr int EE_IMAGE_MAGIC = 0xa5;
+constexpr int MUSIC_MAX = 4;
+constexpr int NOTE_DOT = 0x3e;
+constexpr int NOTE_RUN = 0x3f;
+constexpr int NOTE_MAX = 36;
+
+struct Note
+{
+    int pitch;
+    int len;
+};
+
+struct Song
+{
+    std::string name;
+    int line;
+    std::vector<Note> notes;
+};
+
+[[noreturn]] void Fail(const std::string& file, int line, const std::string& msg)
+{
+    std::cerr << file << ":" << line << ": error: " << msg << "\n";
+    std::exit(1);
+}
+
+std::string Trim(const std::string& s)
+{
+    auto b = s.find_first_not_of(" \t\r\n");
+    if (b == std::string::npos)
+        return "";
+    auto e = s.find_last_not_of(" \t\r\n");
+    return s.substr(b, e - b + 1);
+}
+
+// 音符名 -> FreqTable 索引 (P L1 L1_ ... H7 与之前 music.h 中的定义相同)
+int PitchIndex(const std::string& name)
+{
+    static const char* const scale[] = {"1", "1_", "2", "2_", "3", "4",
+                                        "4_", "5", "5_", "6", "6_", "7"};
+    if (name == "P")
+        return 0;
+    if (name.size() < 2)
+        return -1;
+    int octave;
+    switch (name[0])
+    {
+    case 'L': octave = 0; break;
+    case 'M': octave = 1; break;
+    case 'H': octave = 2; break;
+    default: return -1;
+    }
+    for (int i = 0; i < 12; ++i)
+        if (name.compare(1, std::string::npos, scale[i]) == 0)
+        {
+            int idx = octave * 12 + i + 1;
+            return idx <= NOTE_MAX ? idx : -1;
+        }
+    return -1;
+}
+
+// 一个音符压缩为 1-2 字节 时值 1 2 4 8 或附点 3 6 12
+bool PackNote(std::vector<unsigned char>& out, const Note& n)
+{
+    int len = n.len;
+    if (len == 3 || len == 6 || len == 12)
+    {
+        out.push_back(NOTE_DOT);
+        len = len / 3 * 2;
+    }
+    int dd;
+    switch (len)
+    {
+    case 1: dd = 0; break;
+    case 2: dd = 1; break;
+    case 4: dd = 2; break;
+    case 8: dd = 3; break;
+    default: return false;
+    }
+    out.push_back(static_cast<unsigned char>((dd << 6) | n.pitch));
+    return true;
+}
+
+std::vector<unsigned char> PackSong(const std::string& file, const Song& song)
+{
+    std::vector<unsigned char> out;
+    size_t i = 0;
+    while (i < song.notes.size())
+    {
+        const Note& n = song.notes[i];
+        if (!PackNote(out, n))
+            Fail(file, song.line,
+                 "song '" + song.name + "': duration " + std::to_string(n.len) +
+                     " is not one of 1 2 3 4 6 8 12");
+        size_t run = 0;
+        while (run < 4 && i + 1 + run < song.notes.size() &&
+               song.notes[i + 1 + run].pitch == n.pitch &&
+               song.notes[i + 1 + run].len == n.len)
+            ++run;
+        if (run)
+            out.push_back(static_cast<unsigned char>(((run - 1) << 6) | NOTE_RUN));
+        i += 1 + run;
+    }
+    return out;
+}
+
+void ParseNotes(const std::string& file, int line, const std::string& text, Song& song)
+{
+    std::stringstream ss(text);
+    std::string tok;
+    std::vector<std::string> toks;
+    while (std::getline(ss, tok, ','))
+    {
+        tok = Trim(tok);
+        if (!tok.empty())
+            toks.push_back(tok);
+    }
+    if (toks.size() % 2)
+        Fail(file, line, "notes must be given as 'pitch,duration' pairs");
+    for (size_t i = 0; i < toks.size(); i += 2)
+    {
+        int pitch = PitchIndex(toks[i]);
+        if (pitch < 0)
+            Fail(file, line, "unknown note '" + toks[i] + "'");
+        char* end;
+        long len = std::strtol(toks[i + 1].c_str(), &end, 10);
+        if (*end || len <= 0)
+            Fail(file, line, "bad duration '" + toks[i + 1] + "'");
+        song.notes.push_back({pitch, static_cast<int>(len)});
+    }
+}
+
+int SettingValue(const std::string& file, int line, const std::string& v, int max)
+{
+    char* end;
+    long x = std::strtol(v.c_str(), &end, 0);
+    if (*end || x < 0 || x > max)
+        Fail(file, line, "value '" + v + "' out of range 0-" + std::to_string(max));
+    return static_cast<int>(x);
+}
+
+void WriteC(const std::string& path, const std::string& src, const unsigned char* img)
+{
+    std::ofstream out(path);
+    std::string name = src.substr(src.find_last_of("/\\") + 1);
+    out << "/**\n"
+           " * eeprom_image.c\n"
+           " * 此文件由 tools/eepromc 根据 " << name << " 生成 请勿手动修改\n"
+           " * ----------------------------------------------\n"
+           " * 24c02 的初始镜像 开机时若 24c02 中的镜像标记与此不同 则按页写入\n"
+           " */\n"
+           "#include \"__config__.h\"\n\n"
+           "#ifdef EEPROM_IMAGE_LOADER\n\n"
+           "unsigned char code eepromImage[256] = {\n";
+    char buf[8];
+    for (int i = 0; i < EE_SIZE; ++i)
+    {
+        if (i % 16 == 0)
+            out << "   ";
+        std::snprintf(buf, sizeof buf, " 0x%02x,", img[i]);
+        out << buf;
+        if (i % 16 == 15)
+        {
+            std::snprintf(buf, sizeof buf, "%02x", i - 15);
+            out << " // " << buf << "\n";
+        }
+    }
+    out << "};\n\n#endif // EEPROM_IMAGE_LOADER\n";
+}
+
+void WriteHex(const std::string& path, const unsigned char* img)
+{
+    std::ofstream out(path);
+    char buf[64];
+    for (int addr = 0; addr < EE_SIZE; addr += 16)
+    {
+        int sum = 16 + (addr >> 8) + (addr & 0xff);
+        std::snprintf(buf, sizeof buf, ":10%04X00", addr);
+        out << buf;
+        for (int i = 0; i < 16; ++i)
+        {
+            std::snprintf(buf, sizeof buf, "%02X", img[addr + i]);
+            out << buf;
+            sum += img[addr + i];
+        }
+        std::snprintf(buf, sizeof buf, "%02X\n", (-sum) & 0xff);
+        out << buf;
+    }
+    out << ":00000001FF\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::string src, cPath, binPath, hexPath;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string a = argv[i];
+        if ((a == "-c" || a == "-b" || a == "-x") && i + 1 < argc)
+            (a == "-c" ? cPath : a == "-b" ? binPath : hexPath) = argv[++i];
+        else if (a[0] != '-' && src.empty())
+            src = a;
+        else
+        {
+            std::cerr << "usage: eepromc songs.txt [-c file.c] [-b file.bin] "
+                         "[-x file.hex]\n";
+            return 2;
+        }
+    }
+    if (src.empty())
+    {
+        std::cerr << "usage: eepromc songs.txt [-c file.c] [-b file.bin] [-x file.hex]\n";
+        return 2;
+    }
+    std::ifstream in(src);
+    if (!in)
+    {
+        std::cerr << src << ": cannot open\n";
+        return 1;
+    }
+
+    int fanGearStep = 2, ringtoneNum = 1, ringRate = 6, version = 1;
+    // 与 control.c 中 CtrlDefault 相同
+    int control[] = {0, 16, 16, 16, 4}; // mode hystHigh hystLow kp ki
+    const char* controlKeys[] = {"mode", "hystHigh", "hystLow", "kp", "ki"};
+    const int controlMax[] = {1, 80, 80, 64, 64}; // 与 control.c 中 CtrlMax 相同
+    std::vector<Song> songs;
+    bool inSettings = false, inControl = false;
+    std::string line;
+    for (int ln = 1; std::getline(in, line); ++ln)
+    {
+        auto hash = line.find('#');
+        if (hash != std::string::npos)
+            line.erase(hash);
+        line = Trim(line);
+        if (line.empty())
+            continue;
+        if (line.front() == '[')
+        {
+            if (line.back() != ']')
+                Fail(src, ln, "unterminated section header");
+            std::string sec = Trim(line.substr(1, line.size() - 2));
+            inSettings = sec == "settings";
+            inControl = sec == "control";
+            if (!inSettings && !inControl)
+            {
+                if (sec.compare(0, 4, "song") != 0)
+                    Fail(src, ln, "unknown section '" + sec + "'");
+                if (songs.size() == MUSIC_MAX)
+                    Fail(src, ln, "at most 4 songs fit in the address table");
+                songs.push_back({Trim(sec.substr(4)), ln, {}});
+            }
+            continue;
+        }
+        if (inSettings)
+        {
+            auto eq = line.find('=');
+            if (eq == std::string::npos)
+                Fail(src, ln, "expected 'key = value'");
+            std::string k = Trim(line.substr(0, eq)), v = Trim(line.substr(eq + 1));
+            if (k == "fanGearStep")
+                fanGearStep = SettingValue(src, ln, v, 3);
+            else if (k == "ringtoneNum")
+                ringtoneNum = SettingValue(src, ln, v, 3);
+            else if (k == "ringRate")
+                ringRate = SettingValue(src, ln, v, 7);
+            else if (k == "version")
+                version = SettingValue(src, ln, v, 0xff);
+            else
+                Fail(src, ln, "unknown setting '" + k + "'");
+        }
+        else if (inControl)
+        {
+            auto eq = line.find('=');
+            if (eq == std::string::npos)
+                Fail(src, ln, "expected 'key = value'");
+            std::string k = Trim(line.substr(0, eq)), v = Trim(line.substr(eq + 1));
+            size_t i = 0;
+            while (i < std::size(controlKeys) && k != controlKeys[i])
+                ++i;
+            if (i == std::size(controlKeys))
+                Fail(src, ln, "unknown control parameter '" + k + "'");
+            control[i] = SettingValue(src, ln, v, controlMax[i]);
+        }
+        else if (songs.empty())
+            Fail(src, ln, "notes outside of a [song] section");
+        else
+            ParseNotes(src, ln, line, songs.back());
+    }
+
+    unsigned char img[EE_SIZE];
+    std::fill(img, img + EE_SIZE, 0xff); // 保留区与日志区为擦除状态
+    img[EE_SETTINGS] = static_cast<unsigned char>(
+        (fanGearStep << 5) | (ringtoneNum << 3) | ringRate
+    );
+    img[EE_IMAGE_TAG] = EE_IMAGE_MAGIC;
+    img[EE_IMAGE_TAG + 1] = static_cast<unsigned char>(version);
+    for (size_t i = 0; i < std::size(control); ++i)
+        img[EE_CONTROL + i] = static_cast<unsigned char>(control[i]);
+
+    int addr = EE_MUSIC;
+    for (size_t i = 0; i <= MUSIC_MAX; ++i)
+    {
+        img[EE_MUSIC_TABLE + i] = static_cast<unsigned char>(addr);
+        if (i >= songs.size())
+            continue; // 没有的歌曲起止地址相同 (长度为0)
+        std::vector<unsigned char> packed = PackSong(src, songs[i]);
+        if (addr + static_cast<int>(packed.size()) > EE_CONTROL)
+            Fail(src, songs[i].line,
+                 "song '" + songs[i].name + "' does not fit: music region is " +
+                     std::to_string(EE_CONTROL - EE_MUSIC) + " bytes");
+        std::copy(packed.begin(), packed.end(), img + addr);
+        std::printf("song %zu %-12s %3zu notes -> %3zu bytes @ 0x%02x\n", i,
+                    songs[i].name.c_str(), songs[i].notes.size(), packed.size(), addr);
+        addr += static_cast<int>(packed.size());
+    }
+    std::printf("music %d/%d bytes, settings 0x%02x, image version %d\n",
+                addr - EE_MUSIC, EE_CONTROL - EE_MUSIC, img[EE_SETTINGS], version);
+
+    if (!cPath.empty())
+        WriteC(cPath, src, img);
+    if (!binPath.empty())
+        std::ofstream(binPath, std::ios::binary)
+            .write(reinterpret_cast<const char*>(img), EE_SIZE);
+    if (!hexPath.empty())
+        WriteHex(hexPath, img);
+    return 0;
+}
@@ -0,0 +1,207 @@
+/**
+ * fmtcheck.cpp
+ * ----------------------------------------------
+ * 主机端检查: src/utility.c 的整数版本与原来的浮点版本输出完全相同
+ * 直接编译固件中的 src/utility.c 原来的 FloatToString Int8ToString 复制在下面 (基线提交中的 utility.c 下标加了 uchar 转换)
+ *
+ * 编译: g++ -std=c++17 -O2 -Wall -Wextra -o fmtcheck fmtcheck.cpp (没有警告)
+ * 用法: fmtcheck  有不同时列出前几个并返回 1
+ *
+ * 穷举:
+ *   Temp16ToString(raw, s, len) 与 FloatToString(raw * 0.0625, s, len, 1)
+ *     raw 为 -55 到 125 度的每个 1/16 度 len 3-7 (与 UpdateTemperature 相同 先转为 float 再乘 0.0625)
+ *   Int8ToString 新旧两个版本 num -127 到 127 len 0-5 (旧版本 -128 输出错误 只检查新版本的结果)
+ *   比较整个缓冲 (含结束符和前后的字节) 越界写入也算不同
+ * 8051 上的代价 (基线: proj_keil5 中 2023 年的构建 用 map51 和 wcet51 得到):
+ *   FloatToString 677 字节 另链接 C51FPS.LIB 1190 字节  最坏 15624 个机器周期 (16.9ms)
+ *   Int8ToString  180 字节                              最坏   544 个机器周期
+ *   基线的报告在 tools/map51/baseline-2023.txt 和 tools/wcet51/baseline-2023.txt
+ *   重新编译后用 map51 -p 和 wcet51 -p 与之比较 得到新版本的字节数和周期
+ */
+#include "../../src/utility.c"
+#undef uchar
+#undef uint
+#undef bit
+#undef code
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace old {
+
+#define uchar unsigned char
+#define uint unsigned int
+
+// 基线中的 FloatToString (C51 的 float 与主机相同 为 IEEE 单精度)
+void FloatToString(float num, uchar* str, uchar length, uchar decimal)
+{
+    char i, mid;
+    uint intn, decn;
+    float dec, std;
+
+    str[length] = 0; // 字符串结束标志位
+
+    std = 0.4f;
+    if (decimal != 0)
+    {
+        if (decimal + (num < 0) + 1 > length)
+        {
+            mid = num < 0;
+            decimal = length - 1 - (num < 0);
+        }
+        else
+            mid = length - decimal - 1;
+        str[(uchar)mid] = '.';
+    }
+    else
+        mid = length;
+
+    i = decimal;
+    while (i--)
+        std *= 0.1f;
+
+    if (num < 0)
+    {
+        num -= std;
+        intn = -(int)num;
+        dec = (int)num - num;
+    }
+    else
+    {
+        num += std;
+        intn = (int)num;
+        dec = num - intn;
+    }
+
+    for (i = mid + 1; i < length; ++i)
+    {
+        dec *= 10;
+        decn = (uchar)dec;
+        str[(uchar)i] = decn + '0';
+        dec -= decn;
+    }
+    for (i = mid - 1; i > 0; --i)
+    {
+        str[(uchar)i] = intn % 10 + '0';
+        intn /= 10;
+        if (intn == 0)
+        {
+            --i;
+            break;
+        }
+    }
+    str[(uchar)i] = num < 0 ? '-' : (intn == 0 && mid != 1 ? ' ' : intn % 10 + '0');
+    while (i-- > 0)
+        str[(uchar)i] = ' ';
+}
+
+void Int8ToString(char num, uchar* str, uchar length)
+{
+    unsigned char neg;
+
+    str[length] = 0; // 字符串结束标志位
+
+    neg = num < 0;
+    if (!length)
+        return;
+    if (neg)
+    {
+        if (!--length)
+            return;
+        ++str;
+        num = ~num;
+        ++num;
+    }
+    str[--length] = num % 10 + '0';
+    while (length)
+    {
+        num /= 10;
+        if (!num)
+            break;
+        str[--length] = num % 10 + '0';
+    }
+    if (neg)
+    {
+        --str;
+        if (!length)
+            *str = '-';
+        str[length] = '-';
+    }
+    while (length)
+        str[--length] = ' ';
+}
+
+#undef uchar
+#undef uint
+
+} // namespace old
+
+namespace {
+
+constexpr int GUARD = 4; // 缓冲前后检查越界写入的字节数
+constexpr int SIZE = 16;
+
+struct Buffer
+{
+    unsigned char b[GUARD + SIZE + GUARD];
+    Buffer() { std::memset(b, '#', sizeof b); }
+    unsigned char* str() { return b + GUARD; }
+    bool operator==(const Buffer& o) const { return std::memcmp(b, o.b, sizeof b) == 0; }
+    std::string text() const
+    {
+        std::string s;
+        for (unsigned char c : b)
+            s += c ? static_cast<char>(c) : '|'; // 结束符显示为 |
+        return s;
+    }
+};
+
+int mismatches = 0;
+
+void Report(const char* what, int num, int len, const Buffer& want, const Buffer& got)
+{
+    if (++mismatches <= 10)
+        std::printf("%s(%d, len %d)\n  old \"%s\"\n  new \"%s\"\n", what, num, len, want.text().c_str(),
+                    got.text().c_str());
+}
+
+} // namespace
+
+int main()
+{
+    long cases = 0;
+    for (int raw = -55 * 16; raw <= 125 * 16; ++raw)
+        for (int len = 3; len <= 7; ++len)
+        {
+            Buffer want, got;
+            float t = static_cast<float>(raw);
+            t *= 0.0625f;
+            old::FloatToString(t, want.str(), static_cast<unsigned char>(len), 1);
+            Temp16ToString(raw, got.str(), static_cast<unsigned char>(len));
+            ++cases;
+            if (!(want == got))
+                Report("Temp16ToString", raw, len, want, got);
+        }
+    for (int num = -127; num <= 127; ++num)
+        for (int len = 0; len <= 5; ++len)
+        {
+            Buffer want, got;
+            old::Int8ToString(static_cast<char>(num), want.str(), static_cast<unsigned char>(len));
+            Int8ToString(static_cast<char>(num), got.str(), static_cast<unsigned char>(len));
+            ++cases;
+            if (!(want == got))
+                Report("Int8ToString", num, len, want, got);
+        }
+    // -128: 旧版本取反后仍为负数 这里只检查新版本
+    {
+        Buffer want, got;
+        std::memcpy(want.str(), "-128", 5);
+        Int8ToString(static_cast<char>(-128), got.str(), 4);
+        ++cases;
+        if (!(want == got))
+            Report("Int8ToString", -128, 4, want, got);
+    }
+    std::printf("fmtcheck: %ld cases, %d mismatches\n", cases, mismatches);
+    return mismatches ? 1 : 0;
+}
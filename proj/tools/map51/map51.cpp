@@ -0,0 +1,559 @@
+/**
+ * map51.cpp
+ * ----------------------------------------------
+ * 主机端工具: 按 Keil BL51 的链接映像 (.m51) 列出 DATA IDATA BIT CODE 的占用
+ * 编译日志只有 "data=209.6 xdata=0 code=6939" 这里按模块、按符号拆开 (包括库中的浮点运算)
+ * 每加一个功能 都可以用 -p 和上次的报告比较 看它占用了多少 RAM 和 ROM
+ *
+ * 编译: g++ -std=c++17 -O2 -o map51 map51.cpp
+ * 用法: map51 [-r 代码上限] [-s 最少栈空间] [-p 上次的报告] Ultimate.m51 > map.txt
+ *   -r 代码超过上限时失败 默认 8192 (AT89C52 的 8KB)
+ *   -s ?STACK 到 RAMSIZE 之间的空间 (栈可用的 idata) 少于这个字节数时失败
+ *   有失败时返回 1 (用于构建后检查)
+ *
+ * 归属:
+ *   段名 ?PR?函数?模块 ?CO?模块 ?DT?模块 ?ID?模块 ?BI?模块 归到最后的模块名
+ *   ?C?LIB_CODE 按库模块的 PUBLIC 地址切分 (没有 PUBLIC 的库模块如 ?C?FPGETOPN 算在前一个中)
+ *   _DATA_GROUP_ _BIT_GROUP_ 为可覆盖的局部变量 按 OVERLAY MAP 归到函数
+ *     不同时调用的函数共用同一块 所以模块的 ovl 为它的函数占用范围的并集 各模块之和大于组的长度
+ *   符号没有长度 按同一段中下一个符号的地址计算 (覆盖区中只看同一函数的符号)
+ */
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// BIT 段的地址与长度以位为单位 (位地址 = (字节 - 20H) * 8 + 位) 其他为字节
+struct Segment
+{
+    std::string type, base, reloc, name; // base 为 .m51 中的写法 用于显示
+    unsigned addr = 0, len = 0;
+};
+
+struct Overlay
+{
+    int bitAddr = -1, dataAddr = -1;
+    unsigned bitLen = 0, dataLen = 0;
+};
+
+struct Symbol
+{
+    char space; // B C D I X
+    unsigned addr;
+    std::string text, name, module, proc; // text 为 .m51 中的地址写法
+};
+
+unsigned Hex(const std::string& s)
+{
+    return static_cast<unsigned>(std::strtoul(s.c_str(), nullptr, 16));
+}
+
+// "0021H" "4" -> 位地址
+unsigned Bits(const std::string& byte, const std::string& bit, unsigned origin)
+{
+    return (Hex(byte) - origin) * 8 + (bit.empty() ? 0 : std::atoi(bit.c_str()));
+}
+
+struct MapFile
+{
+    unsigned ramsize = 128; // BL51 的默认值
+    std::string model, programSize;
+    std::vector<Segment> segments;
+    std::map<std::string, Overlay> overlay;  // ?PR?函数?模块 -> 覆盖区
+    std::vector<Symbol> symbols;
+    std::map<std::string, std::string> sources; // 模块 -> .obj 或 .LIB
+
+    bool Load(const std::string& path)
+    {
+        std::ifstream in(path);
+        if (!in)
+            return false;
+        static const std::regex seg(
+            R"(^\s+(REG|BIT|DATA|IDATA|XDATA|CODE)\s+([0-9A-F]+)H(?:\.([0-7]))?\s+([0-9A-F]+)H(?:\.([0-7]))?\s+(\w+)\s*(.*?)\s*$)");
+        static const std::regex ovl(
+            R"(^(\S+)\s+(?:-----|([0-9A-F]+)H\.([0-7]))\s+(?:-----|([0-9A-F]+)H\.([0-7]))\s+(?:-----|([0-9A-F]+)H)\s+(?:-----|([0-9A-F]+)H)\s*$)");
+        static const std::regex sym(R"(^\s+([BCDIX]):([0-9A-F]+)H(?:\.([0-7]))?\s+(?:PUBLIC|SYMBOL)\s+(\S+)\s*$)");
+        static const std::regex mark(R"(^\s+-------\s+(MODULE|PROC|ENDPROC)\s+(\S+))");
+        static const std::regex input(R"(^\s+(.+?)\s+\((\S+)\)\s*$)");
+        static const std::regex ram(R"(RAMSIZE\s*\(\s*(\d+)\s*\))");
+        enum { HEAD, INPUT, LINK, OVERLAY, SYMBOLS } part = HEAD;
+        std::string line, invoked, module, proc;
+        std::smatch m;
+        while (std::getline(in, line))
+        {
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            if (line.rfind("BL51 BANKED LINKER", 0) == 0)
+                continue; // 分页的页眉
+            if (part == HEAD && line.rfind(">> ", 0) == 0)
+                invoked += line.substr(3);
+            else if (part == HEAD && line.find("INVOKED BY:") != std::string::npos)
+                invoked.clear();
+            else if (line.rfind("MEMORY MODEL:", 0) == 0)
+                model = line.substr(line.find(':') + 2);
+            else if (line.rfind("INPUT MODULES INCLUDED:", 0) == 0)
+                part = INPUT;
+            else if (line.rfind("LINK MAP OF MODULE:", 0) == 0)
+                part = LINK;
+            else if (line.rfind("OVERLAY MAP OF MODULE:", 0) == 0)
+                part = OVERLAY;
+            else if (line.rfind("SYMBOL TABLE OF MODULE:", 0) == 0)
+                part = SYMBOLS;
+            else if (line.rfind("Program Size:", 0) == 0)
+                programSize = line.substr(14);
+            else if (part == INPUT && std::regex_match(line, m, input))
+            {
+                std::string file = m[1];
+                auto slash = file.find_last_of("\\/");
+                sources[m[2]] = slash == std::string::npos ? file : file.substr(slash + 1);
+            }
+            else if (part == LINK && std::regex_match(line, m, seg))
+            {
+                Segment s;
+                s.type = m[1];
+                s.base = std::string(m[2]) + "H" + (m[3].matched ? "." + std::string(m[3]) : "");
+                if (s.type == "BIT")
+                    s.addr = Bits(m[2], m[3], 0x20), s.len = Bits(m[4], m[5], 0);
+                else
+                    s.addr = Hex(m[2]), s.len = Hex(m[4]);
+                s.reloc = m[6];
+                s.name = m[7];
+                if (s.type == "REG")
+                    s.name.erase(std::remove(s.name.begin(), s.name.end(), '"'), s.name.end());
+                segments.push_back(s);
+            }
+            else if (part == OVERLAY && std::regex_match(line, m, ovl))
+            {
+                Overlay o;
+                if (m[2].matched)
+                    o.bitAddr = static_cast<int>(Bits(m[2], m[3], 0x20)), o.bitLen = Bits(m[4], m[5], 0);
+                if (m[6].matched)
+                    o.dataAddr = static_cast<int>(Hex(m[6])), o.dataLen = Hex(m[7]);
+                if (o.bitLen || o.dataLen)
+                    overlay[m[1]] = o;
+            }
+            else if (part == SYMBOLS && std::regex_search(line, m, mark))
+            {
+                if (m[1] == "MODULE")
+                    module = m[2], proc.clear();
+                else
+                    proc = m[1] == "PROC" ? std::string(m[2]) : std::string();
+            }
+            else if (part == SYMBOLS && std::regex_match(line, m, sym))
+            {
+                Symbol s;
+                s.space = std::string(m[1])[0];
+                unsigned byte = Hex(m[2]);
+                // 特殊功能寄存器 (D:80H 以上 及其中的位) 不占 RAM
+                if ((s.space == 'D' && byte >= 0x80) || (s.space == 'B' && (byte < 0x20 || byte >= 0x30)))
+                    continue;
+                s.addr = s.space == 'B' ? Bits(m[2], m[3], 0x20) : byte;
+                s.text = std::string(m[1]) + ":" + std::string(m[2]) + "H" + (m[3].matched ? "." + std::string(m[3]) : "");
+                s.name = m[4];
+                s.module = module;
+                s.proc = proc;
+                symbols.push_back(s);
+            }
+        }
+        if (std::regex_search(invoked, m, ram))
+            ramsize = static_cast<unsigned>(std::atoi(std::string(m[1]).c_str()));
+        return true;
+    }
+};
+
+bool Overlaid(const Segment& s)
+{
+    return s.name == "_DATA_GROUP_" || s.name == "_BIT_GROUP_";
+}
+
+// 段归属的模块 覆盖区与库代码另外处理
+std::string Owner(const Segment& s)
+{
+    if (s.type == "REG")
+        return "(regs)";
+    if (s.name == "?STACK")
+        return "(stack)";
+    if (s.name.empty())
+        return "(vectors)"; // 向量处的 ABSOLUTE 段 (LJMP)
+    if (s.name == "?C_C51STARTUP")
+        return "?C_STARTUP";
+    if (s.name == "?C_INITSEG")
+        return "?C_INIT"; // 所有模块中有初值的变量的初始化表
+    if (s.name.size() > 4 && s.name[0] == '?' && s.name[3] == '?') // ?PR? ?CO? ?DT? ?ID? ?BI? ?XD?
+        return s.name.substr(s.name.rfind('?') + 1);
+    return s.name;
+}
+
+// 段中的符号是否为这个地址空间
+bool Inside(const Segment& s, const Symbol& sym)
+{
+    if (s.type == "BIT")
+        return sym.space == 'B';
+    if (s.type == "DATA")
+        return sym.space == 'D' || sym.space == 'I';
+    if (s.type == "IDATA")
+        return sym.space == 'I' || sym.space == 'D';
+    if (s.type == "XDATA")
+        return sym.space == 'X';
+    return s.type == "CODE" && sym.space == 'C';
+}
+
+struct Piece
+{
+    std::string name, module;
+    unsigned size;
+};
+
+// ?C?LIB_CODE 按库模块切分: 每个模块从它最低的 PUBLIC 到下一个模块 第一个模块从段首开始
+std::vector<Piece> SplitLibrary(const Segment& s, const MapFile& map)
+{
+    std::map<std::string, unsigned> first;
+    for (const auto& sym : map.symbols)
+        if (sym.space == 'C' && sym.module.rfind("?C?", 0) == 0 && sym.addr >= s.addr && sym.addr < s.addr + s.len)
+        {
+            auto it = first.find(sym.module);
+            if (it == first.end() || sym.addr < it->second)
+                first[sym.module] = sym.addr;
+        }
+    std::vector<std::pair<unsigned, std::string>> order;
+    for (const auto& [module, addr] : first)
+        order.emplace_back(addr, module);
+    std::sort(order.begin(), order.end());
+    std::vector<Piece> pieces;
+    if (order.empty())
+        return {{s.name, s.name, s.len}};
+    order[0].first = s.addr;
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        unsigned end = i + 1 < order.size() ? order[i + 1].first : s.addr + s.len;
+        pieces.push_back({order[i].second, order[i].second, end - order[i].first});
+    }
+    return pieces;
+}
+
+struct Usage
+{
+    unsigned code = 0, konst = 0, data = 0, idata = 0, bits = 0, ovl = 0, ovlBits = 0;
+};
+
+// 上次报告中 memory 段每行的第二列 与 modules 段每行的各列
+std::map<std::string, std::string> LoadPrevious(const std::string& path)
+{
+    static const char* const columns[] = {"code", "const", "data", "idata", "bit", "ovl", "ovlbit"};
+    std::map<std::string, std::string> prev;
+    std::ifstream in(path);
+    std::string line, section, name, value;
+    while (std::getline(in, line))
+    {
+        if (line.empty())
+            section.clear();
+        else if (line[0] != ' ')
+            section = line.substr(0, line.find(' '));
+        else
+        {
+            std::istringstream ss(line);
+            if (section == "memory" && ss >> name >> value)
+                prev[name] = value;
+            else if (section == "modules" && ss >> name >> value)
+            {
+                // total 与库的小计没有 source 列
+                std::map<std::string, std::string> row;
+                for (const char* c : columns)
+                    if (ss >> value)
+                        row[name + " " + c] = value;
+                if (row.size() == std::size(columns))
+                    prev.insert(row.begin(), row.end());
+            }
+        }
+    }
+    return prev;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    long codeMax = 8192, stackMin = -1;
+    std::string prevPath;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string a = argv[i];
+        if (a == "-r" && i + 1 < argc)
+            codeMax = std::atol(argv[++i]);
+        else if (a == "-s" && i + 1 < argc)
+            stackMin = std::atol(argv[++i]);
+        else if (a == "-p" && i + 1 < argc)
+            prevPath = argv[++i];
+        else if (a[0] != '-')
+            files.push_back(a);
+        else
+            files.clear(), i = argc;
+    }
+    if (files.size() != 1 || codeMax <= 0)
+    {
+        std::cerr << "usage: map51 [-r max_code] [-s min_stack_free] [-p previous_report] file.m51\n";
+        return 2;
+    }
+
+    MapFile map;
+    if (!map.Load(files[0]))
+    {
+        std::cerr << "map51: cannot open " << files[0] << '\n';
+        return 1;
+    }
+    if (map.segments.empty())
+    {
+        std::cerr << "map51: no LINK MAP in " << files[0] << '\n';
+        return 1;
+    }
+
+    // 按模块汇总 片内 RAM 按字节标记 (BIT 段标记所在的字节)
+    std::map<std::string, Usage> modules;
+    std::vector<Piece> code;
+    std::vector<bool> used(256, false);
+    unsigned dataBytes = 0, dataBits = 0, xdata = 0, codeTotal = 0;
+    const Segment* stack = nullptr;
+    for (const auto& s : map.segments)
+    {
+        if (s.type == "CODE")
+        {
+            codeTotal += s.len;
+            if (s.name == "?C?LIB_CODE")
+                for (const auto& p : SplitLibrary(s, map))
+                {
+                    modules[p.module].code += p.size;
+                    code.push_back({p.name + " (" + s.name + ")", p.module, p.size});
+                }
+            else
+            {
+                Usage& u = modules[Owner(s)];
+                (s.name.rfind("?CO?", 0) == 0 ? u.konst : u.code) += s.len;
+                code.push_back({s.name.empty() ? "(vector " + s.base + ")" : s.name, Owner(s), s.len});
+            }
+            continue;
+        }
+        if (s.type == "XDATA")
+        {
+            xdata += s.len;
+            continue;
+        }
+        if (s.type == "BIT")
+        {
+            dataBits += s.len;
+            for (unsigned b = s.addr; b < s.addr + s.len; ++b)
+                used[0x20 + b / 8] = true;
+        }
+        else
+        {
+            dataBytes += s.len;
+            for (unsigned a = s.addr; a < s.addr + s.len && a < used.size(); ++a)
+                used[a] = true;
+        }
+        if (s.name == "?STACK")
+            stack = &s;
+        if (Overlaid(s))
+            continue;
+        Usage& u = modules[Owner(s)];
+        (s.type == "BIT" ? u.bits : s.type == "IDATA" ? u.idata : u.data) += s.len;
+    }
+    std::map<std::string, std::set<unsigned>> ovlData, ovlBits;
+    for (const auto& [seg, o] : map.overlay)
+    {
+        Segment s;
+        s.name = seg;
+        std::string module = Owner(s);
+        for (unsigned i = 0; i < o.dataLen; ++i)
+            ovlData[module].insert(o.dataAddr + i);
+        for (unsigned i = 0; i < o.bitLen; ++i)
+            ovlBits[module].insert(o.bitAddr + i);
+    }
+    for (const auto& [module, bytes] : ovlData)
+        modules[module].ovl = static_cast<unsigned>(bytes.size());
+    for (const auto& [module, bits] : ovlBits)
+        modules[module].ovlBits = static_cast<unsigned>(bits.size());
+
+    // 与编译日志的写法相同 (data 为字节.位) 用来核对解析的结果
+    char size[80];
+    std::snprintf(size, sizeof size, "data=%u.%u xdata=%u code=%u", dataBytes + dataBits / 8, dataBits % 8, xdata,
+                  codeTotal);
+    std::printf("map51: %s  RAMSIZE %u  %s\n", files[0].c_str(), map.ramsize, map.model.c_str());
+    std::printf("linker: %s", map.programSize.c_str());
+    if (map.programSize != size)
+        std::printf("  (segments add up to %s)", size);
+    std::printf("\nbytes, bit columns in bits\n\n");
+
+    // ---- 总量 ----
+    unsigned low = static_cast<unsigned>(std::count(used.begin(), used.begin() + 128, true));
+    unsigned high = static_cast<unsigned>(std::count(used.begin() + 128, used.end(), true));
+    unsigned highSize = map.ramsize > 128 ? map.ramsize - 128 : 0;
+    long stackFree = stack ? static_cast<long>(map.ramsize) - static_cast<long>(stack->addr) : 0;
+    std::map<std::string, std::string> now; // 用于 -p
+    std::printf("memory          used    size    free\n");
+    std::printf("  code        %6u  %6ld  %6ld\n", codeTotal, codeMax, codeMax - static_cast<long>(codeTotal));
+    std::printf("  ram00-7F    %6u  %6u  %6u   registers, bits, data and the start of idata\n", low, 128u, 128 - low);
+    if (highSize)
+        std::printf("  ram80-FF    %6u  %6u  %6u   idata only\n", high, highSize, highSize - high);
+    if (xdata)
+        std::printf("  xdata       %6u\n", xdata);
+    if (stack)
+        std::printf("  stack       %6ld bytes of idata free for the stack (?STACK at %s up to %02XH)\n", stackFree,
+                    stack->base.c_str(), map.ramsize - 1);
+    now["code"] = std::to_string(codeTotal);
+    now["ram00-7F"] = std::to_string(low);
+    if (highSize)
+        now["ram80-FF"] = std::to_string(high);
+    if (xdata)
+        now["xdata"] = std::to_string(xdata);
+    if (stack)
+        now["stack"] = std::to_string(stackFree);
+
+    // ---- 模块 ----
+    Usage total;
+    std::printf("\nmodules         source          code  const   data  idata    bit    ovl ovlbit\n");
+    for (const auto& [name, u] : modules)
+    {
+        auto src = map.sources.find(name);
+        std::printf("  %-13s %-13s %6u %6u %6u %6u %6u %6u %6u\n", name.c_str(),
+                    src == map.sources.end() ? "-" : src->second.c_str(), u.code, u.konst, u.data, u.idata, u.bits,
+                    u.ovl, u.ovlBits);
+        const std::pair<const char*, unsigned> columns[] = {{"code", u.code}, {"const", u.konst}, {"data", u.data},
+                                                            {"idata", u.idata}, {"bit", u.bits}, {"ovl", u.ovl},
+                                                            {"ovlbit", u.ovlBits}};
+        for (const auto& [c, v] : columns)
+            now[name + " " + c] = std::to_string(v);
+        total.code += u.code, total.konst += u.konst, total.data += u.data, total.idata += u.idata;
+        total.bits += u.bits;
+    }
+    for (const auto& s : map.segments)
+        if (Overlaid(s))
+            (s.type == "BIT" ? total.ovlBits : total.ovl) += s.len;
+    std::printf("  %-27s %6u %6u %6u %6u %6u %6u %6u\n", "total", total.code, total.konst, total.data, total.idata,
+                total.bits, total.ovl, total.ovlBits);
+    std::map<std::string, unsigned> libraries;
+    for (const auto& [name, u] : modules)
+    {
+        auto src = map.sources.find(name);
+        if (src != map.sources.end() && src->second.size() > 4 && src->second.substr(src->second.size() - 4) == ".LIB")
+            libraries[src->second] += u.code + u.konst;
+    }
+    for (const auto& [lib, bytes] : libraries)
+        std::printf("  %-27s %6u\n", lib.c_str(), bytes);
+
+    // ---- 代码 ----
+    std::stable_sort(code.begin(), code.end(), [](const Piece& a, const Piece& b) { return a.size > b.size; });
+    std::printf("\ncode (largest first)\n");
+    for (const auto& p : code)
+        std::printf("  %-40s %6u  %s\n", p.name.c_str(), p.size, p.module.c_str());
+
+    // ---- 覆盖区 ----
+    std::printf("\noverlay (functions never active at the same time share _DATA_GROUP_ and _BIT_GROUP_)\n");
+    std::vector<std::pair<std::string, Overlay>> ovls(map.overlay.begin(), map.overlay.end());
+    std::stable_sort(ovls.begin(), ovls.end(), [](const auto& a, const auto& b) {
+        return std::make_pair(a.second.dataAddr, a.second.bitAddr) < std::make_pair(b.second.dataAddr, b.second.bitAddr);
+    });
+    for (const auto& [seg, o] : ovls)
+    {
+        std::string data = o.dataLen ? std::to_string(o.dataLen) : "-";
+        std::string bits = o.bitLen ? std::to_string(o.bitLen) : "-";
+        char at[32] = "";
+        if (o.dataLen)
+            std::snprintf(at, sizeof at, "D:%04XH", static_cast<unsigned>(o.dataAddr));
+        std::printf("  %-40s %-8s %4s  bits %s\n", seg.c_str(), at, data.c_str(), bits.c_str());
+    }
+
+    // ---- 符号 ----
+    std::printf("\nsymbols (size up to the next symbol in the segment, locals in the overlay up to the next local "
+                "of the same function)\n");
+    for (const auto& s : map.segments)
+    {
+        bool constant = s.type == "CODE" && s.name.rfind("?CO?", 0) == 0;
+        if (s.type == "REG" || s.name == "?STACK" || (s.type == "CODE" && !constant))
+            continue;
+        std::vector<const Symbol*> in;
+        std::set<std::pair<unsigned, std::string>> seen;
+        for (const auto& sym : map.symbols)
+            if (Inside(s, sym) && sym.addr >= s.addr && sym.addr < s.addr + s.len && sym.name[0] != '?' &&
+                seen.insert({sym.addr, sym.module + sym.proc + sym.name}).second)
+                in.push_back(&sym);
+        std::stable_sort(in.begin(), in.end(), [](const Symbol* a, const Symbol* b) { return a->addr < b->addr; });
+        std::printf("  %s %s %u\n", s.name.c_str(), s.base.c_str(), s.len);
+        if (!in.empty() && in[0]->addr > s.addr && !Overlaid(s))
+            std::printf("    %-12s %5u  (no symbol)\n", "", in[0]->addr - s.addr);
+        for (size_t i = 0; i < in.size(); ++i)
+        {
+            const Symbol& sym = *in[i];
+            unsigned end = s.addr + s.len;
+            if (Overlaid(s))
+            {
+                auto o = map.overlay.find("?PR?" + sym.proc + "?" + sym.module);
+                if (o != map.overlay.end())
+                    end = s.type == "BIT" ? o->second.bitAddr + o->second.bitLen
+                                          : o->second.dataAddr + o->second.dataLen;
+                for (size_t j = i + 1; j < in.size(); ++j)
+                    if (in[j]->addr > sym.addr && in[j]->proc == sym.proc && in[j]->module == sym.module)
+                    {
+                        end = std::min(end, in[j]->addr);
+                        break;
+                    }
+            }
+            else
+                for (size_t j = i + 1; j < in.size(); ++j)
+                    if (in[j]->addr > sym.addr)
+                    {
+                        end = in[j]->addr;
+                        break;
+                    }
+            std::string owner = sym.proc.empty() ? sym.module : sym.module + "/" + sym.proc;
+            std::printf("    %-12s %5u  %-24s %s\n", sym.text.c_str(), end > sym.addr ? end - sym.addr : 0,
+                        sym.name.c_str(), owner.c_str());
+        }
+    }
+
+    // ---- 预算 ----
+    bool failed = false;
+    std::printf("\nbudgets\n");
+    bool codeBad = static_cast<long>(codeTotal) > codeMax;
+    std::printf("  code   %u of %ld  %s\n", codeTotal, codeMax, codeBad ? "FAIL" : "ok");
+    failed |= codeBad;
+    if (stackMin >= 0)
+    {
+        bool stackBad = !stack || stackFree < stackMin;
+        std::printf("  stack  %ld free (need %ld)  %s\n", stackFree, stackMin, stackBad ? "FAIL" : "ok");
+        failed |= stackBad;
+    }
+
+    if (!prevPath.empty())
+    {
+        auto prev = LoadPrevious(prevPath);
+        std::printf("\nchanges against %s\n", prevPath.c_str());
+        for (const auto& [name, value] : now)
+        {
+            auto it = prev.find(name);
+            if (it == prev.end())
+            {
+                if (value != "0")
+                    std::printf("  %-24s %8s  (new)\n", name.c_str(), value.c_str());
+            }
+            else if (it->second != value)
+            {
+                long delta = std::atol(value.c_str()) - std::atol(it->second.c_str());
+                std::printf("  %-24s %8s -> %-8s %+ld\n", name.c_str(), it->second.c_str(), value.c_str(), delta);
+            }
+        }
+        for (const auto& [name, value] : prev)
+            if (!now.count(name) && value != "0")
+                std::printf("  %-24s %8s  (removed)\n", name.c_str(), value.c_str());
+    }
+    return failed ? 1 : 0;
+}
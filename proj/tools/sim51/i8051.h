@@ -0,0 +1,999 @@
+/**
+ * i8051.h
+ * ----------------------------------------------
+ * 主机端工具共用: 8051/8052 的指令表与指令级仿真核心 (只有头文件)
+ * - Ops(): 256 个操作码的 助记符格式 字节数 机器周期 控制流类型 (反汇编与 WCET 分析使用)
+ * - Cpu: 内部 RAM 256 字节 SFR 程序存储器 64K 逐条执行 以机器周期计时
+ *   T0 T1 (方式 0-2) T2 (16 位自动重装) 串口方式1 (T1 方式2 产生波特率)
+ *   两级中断优先级 INT0 的边沿/电平触发
+ *   每个中断占用的机器周期 (最长一次) 以及 T0 T2 中断允许时 溢出时上一次的标志还未清除 (溢出丢失) 的次数
+ * - 端口通过 Bus 与外设相连: 引脚电平 = 锁存器 与 外设驱动 (线与)
+ *   读-改-写 指令读锁存器 其他指令读引脚 (与真实的 8051 相同)
+ * 不仿真: 计数方式 (C/T) GATE T0 方式3 T2 的捕获和波特率方式 MOVX (读为 0xff) 掉电/空闲
+ */
+#ifndef I8051_H
+#define I8051_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <string>
+
+namespace i8051 {
+
+// 控制流类型 (WCET 分析)
+enum class Flow : uint8_t
+{
+    Seq,      // 顺序执行
+    Jump,     // 无条件跳转 AJMP LJMP SJMP
+    Branch,   // 条件跳转 (rel) 或顺序执行
+    Call,     // ACALL LCALL
+    Ret,      // RET
+    Reti,     // RETI
+    Indirect, // JMP @A+DPTR
+};
+
+struct OpInfo
+{
+    const char* fmt; // 助记符 %i 立即数 %I 16 位立即数 %d 直接地址 %b 位地址 %r 相对 %a 11 位 %A 16 位
+    uint8_t bytes;
+    uint8_t cycles;
+    Flow flow;
+};
+
+inline const std::array<OpInfo, 256>& Ops()
+{
+    static const std::array<OpInfo, 256> table = [] {
+        std::array<OpInfo, 256> t{};
+        auto set = [&t](int op, const char* fmt, int bytes, int cycles, Flow flow = Flow::Seq) {
+            t[op] = {fmt, static_cast<uint8_t>(bytes), static_cast<uint8_t>(cycles), flow};
+        };
+        static const char* const rn[] = {"R0", "R1", "R2", "R3", "R4", "R5", "R6", "R7"};
+        static const char* const names[] = {"ADD", "ADDC", "ORL", "ANL", "XRL", "SUBB"};
+        static const int bases[] = {0x20, 0x30, 0x40, 0x50, 0x60, 0x90};
+        // 格式字符串需要一直有效 放在静态存储中
+        static std::array<std::string, 256> keep;
+        auto fmt = [](int op, const std::string& s) { return (keep[op] = s).c_str(); };
+
+        for (int op = 0; op < 256; ++op)
+            set(op, "DB %o", 1, 1); // 未定义 (0xa5)
+        for (int page = 0; page < 8; ++page)
+        {
+            set(page << 5 | 0x01, "AJMP %a", 2, 2, Flow::Jump);
+            set(page << 5 | 0x11, "ACALL %a", 2, 2, Flow::Call);
+        }
+        set(0x00, "NOP", 1, 1);
+        set(0x02, "LJMP %A", 3, 2, Flow::Jump);
+        set(0x03, "RR A", 1, 1);
+        set(0x04, "INC A", 1, 1);
+        set(0x05, "INC %d", 2, 1);
+        set(0x10, "JBC %b,%r", 3, 2, Flow::Branch);
+        set(0x12, "LCALL %A", 3, 2, Flow::Call);
+        set(0x13, "RRC A", 1, 1);
+        set(0x14, "DEC A", 1, 1);
+        set(0x15, "DEC %d", 2, 1);
+        set(0x20, "JB %b,%r", 3, 2, Flow::Branch);
+        set(0x22, "RET", 1, 2, Flow::Ret);
+        set(0x23, "RL A", 1, 1);
+        set(0x30, "JNB %b,%r", 3, 2, Flow::Branch);
+        set(0x32, "RETI", 1, 2, Flow::Reti);
+        set(0x33, "RLC A", 1, 1);
+        set(0x40, "JC %r", 2, 2, Flow::Branch);
+        set(0x50, "JNC %r", 2, 2, Flow::Branch);
+        set(0x60, "JZ %r", 2, 2, Flow::Branch);
+        set(0x70, "JNZ %r", 2, 2, Flow::Branch);
+        set(0x72, "ORL C,%b", 2, 2);
+        set(0x73, "JMP @A+DPTR", 1, 2, Flow::Indirect);
+        set(0x74, "MOV A,#%i", 2, 1);
+        set(0x75, "MOV %d,#%i", 3, 2);
+        set(0x80, "SJMP %r", 2, 2, Flow::Jump);
+        set(0x82, "ANL C,%b", 2, 2);
+        set(0x83, "MOVC A,@A+PC", 1, 2);
+        set(0x84, "DIV AB", 1, 4);
+        set(0x85, "MOV %d,%d", 3, 2); // 编码中源地址在前 Disasm 中交换
+        set(0x90, "MOV DPTR,#%I", 3, 2);
+        set(0x92, "MOV %b,C", 2, 2);
+        set(0x93, "MOVC A,@A+DPTR", 1, 2);
+        set(0xa0, "ORL C,/%b", 2, 2);
+        set(0xa2, "MOV C,%b", 2, 1);
+        set(0xa3, "INC DPTR", 1, 2);
+        set(0xa4, "MUL AB", 1, 4);
+        set(0xb0, "ANL C,/%b", 2, 2);
+        set(0xb2, "CPL %b", 2, 1);
+        set(0xb3, "CPL C", 1, 1);
+        set(0xb4, "CJNE A,#%i,%r", 3, 2, Flow::Branch);
+        set(0xb5, "CJNE A,%d,%r", 3, 2, Flow::Branch);
+        set(0xc0, "PUSH %d", 2, 2);
+        set(0xc2, "CLR %b", 2, 1);
+        set(0xc3, "CLR C", 1, 1);
+        set(0xc4, "SWAP A", 1, 1);
+        set(0xc5, "XCH A,%d", 2, 1);
+        set(0xd0, "POP %d", 2, 2);
+        set(0xd2, "SETB %b", 2, 1);
+        set(0xd3, "SETB C", 1, 1);
+        set(0xd4, "DA A", 1, 1);
+        set(0xd5, "DJNZ %d,%r", 3, 2, Flow::Branch);
+        set(0xe0, "MOVX A,@DPTR", 1, 2);
+        set(0xe4, "CLR A", 1, 1);
+        set(0xe5, "MOV A,%d", 2, 1);
+        set(0xf0, "MOVX @DPTR,A", 1, 2);
+        set(0xf4, "CPL A", 1, 1);
+        set(0xf5, "MOV %d,A", 2, 1);
+
+        for (int k = 0; k < 6; ++k)
+        {
+            int b = bases[k];
+            std::string n = names[k];
+            set(b + 4, fmt(b + 4, n + " A,#%i"), 2, 1);
+            set(b + 5, fmt(b + 5, n + " A,%d"), 2, 1);
+            if (b >= 0x40 && b <= 0x60)
+            {
+                set(b + 2, fmt(b + 2, n + " %d,A"), 2, 1);
+                set(b + 3, fmt(b + 3, n + " %d,#%i"), 3, 2);
+            }
+        }
+        for (int i = 0; i < 2; ++i)
+        {
+            std::string ri = std::string("@R") + char('0' + i);
+            for (int k = 0; k < 6; ++k)
+                set(bases[k] + 6 + i, fmt(bases[k] + 6 + i, std::string(names[k]) + " A," + ri), 1, 1);
+            set(0x06 + i, fmt(0x06 + i, "INC " + ri), 1, 1);
+            set(0x16 + i, fmt(0x16 + i, "DEC " + ri), 1, 1);
+            set(0x76 + i, fmt(0x76 + i, "MOV " + ri + ",#%i"), 2, 1);
+            set(0x86 + i, fmt(0x86 + i, "MOV %d," + ri), 2, 2);
+            set(0xa6 + i, fmt(0xa6 + i, "MOV " + ri + ",%d"), 2, 2);
+            set(0xb6 + i, fmt(0xb6 + i, "CJNE " + ri + ",#%i,%r"), 3, 2, Flow::Branch);
+            set(0xc6 + i, fmt(0xc6 + i, "XCH A," + ri), 1, 1);
+            set(0xd6 + i, fmt(0xd6 + i, "XCHD A," + ri), 1, 1);
+            set(0xe2 + i, fmt(0xe2 + i, "MOVX A," + ri), 1, 2);
+            set(0xe6 + i, fmt(0xe6 + i, "MOV A," + ri), 1, 1);
+            set(0xf2 + i, fmt(0xf2 + i, "MOVX " + ri + ",A"), 1, 2);
+            set(0xf6 + i, fmt(0xf6 + i, "MOV " + ri + ",A"), 1, 1);
+        }
+        for (int r = 0; r < 8; ++r)
+        {
+            std::string n = rn[r];
+            for (int k = 0; k < 6; ++k)
+                set(bases[k] + 8 + r, fmt(bases[k] + 8 + r, std::string(names[k]) + " A," + n), 1, 1);
+            set(0x08 + r, fmt(0x08 + r, "INC " + n), 1, 1);
+            set(0x18 + r, fmt(0x18 + r, "DEC " + n), 1, 1);
+            set(0x78 + r, fmt(0x78 + r, "MOV " + n + ",#%i"), 2, 1);
+            set(0x88 + r, fmt(0x88 + r, "MOV %d," + n), 2, 2);
+            set(0xa8 + r, fmt(0xa8 + r, "MOV " + n + ",%d"), 2, 2);
+            set(0xb8 + r, fmt(0xb8 + r, "CJNE " + n + ",#%i,%r"), 3, 2, Flow::Branch);
+            set(0xc8 + r, fmt(0xc8 + r, "XCH A," + n), 1, 1);
+            set(0xd8 + r, fmt(0xd8 + r, "DJNZ " + n + ",%r"), 2, 2, Flow::Branch);
+            set(0xe8 + r, fmt(0xe8 + r, "MOV A," + n), 1, 1);
+            set(0xf8 + r, fmt(0xf8 + r, "MOV " + n + ",A"), 1, 1);
+        }
+        return t;
+    }();
+    return table;
+}
+
+// 跳转/调用的目标地址 (没有固定目标返回 -1) pc 为指令的地址
+inline int Target(const uint8_t* code, uint16_t pc)
+{
+    uint8_t op = code[pc];
+    const OpInfo& info = Ops()[op];
+    uint16_t next = static_cast<uint16_t>(pc + info.bytes);
+    if ((op & 0x1f) == 0x01 || (op & 0x1f) == 0x11)
+        return (next & 0xf800) | (op >> 5) << 8 | code[static_cast<uint16_t>(pc + 1)];
+    if (op == 0x02 || op == 0x12)
+        return code[static_cast<uint16_t>(pc + 1)] << 8 | code[static_cast<uint16_t>(pc + 2)];
+    if (info.flow == Flow::Jump || info.flow == Flow::Branch)
+        return static_cast<uint16_t>(next + static_cast<int8_t>(code[static_cast<uint16_t>(pc + info.bytes - 1)]));
+    return -1;
+}
+
+// 反汇编一条指令
+inline std::string Disasm(const uint8_t* code, uint16_t pc)
+{
+    uint8_t op = code[pc];
+    const OpInfo& info = Ops()[op];
+    int arg = 1;
+    auto byte = [&](int i) { return code[static_cast<uint16_t>(pc + i)]; };
+    std::string out;
+    char buf[16];
+    for (const char* f = info.fmt; *f; ++f)
+    {
+        if (*f != '%')
+        {
+            out += *f;
+            continue;
+        }
+        switch (*++f)
+        {
+        case 'i':
+        case 'd':
+        case 'o':
+            // MOV dir,dir 编码为 源 目的
+            std::snprintf(buf, sizeof(buf), "%02XH", *f == 'o' ? op : op == 0x85 ? byte(3 - arg) : byte(arg));
+            ++arg;
+            break;
+        case 'b':
+            std::snprintf(buf, sizeof(buf), "%02XH.%d", byte(arg) < 0x80 ? 0x20 + (byte(arg) >> 3) : byte(arg) & 0xf8,
+                          byte(arg) & 7);
+            ++arg;
+            break;
+        case 'I':
+            std::snprintf(buf, sizeof(buf), "%04XH", byte(arg) << 8 | byte(arg + 1));
+            arg += 2;
+            break;
+        case 'r':
+        case 'a':
+        case 'A':
+            std::snprintf(buf, sizeof(buf), "%04XH", Target(code, pc));
+            break;
+        default:
+            buf[0] = 0;
+        }
+        out += buf;
+    }
+    return out;
+}
+
+// SFR 地址
+enum : uint8_t
+{
+    P0 = 0x80,
+    SP = 0x81,
+    DPL = 0x82,
+    DPH = 0x83,
+    PCON = 0x87,
+    TCON = 0x88,
+    TMOD = 0x89,
+    TL0 = 0x8a,
+    TL1 = 0x8b,
+    TH0 = 0x8c,
+    TH1 = 0x8d,
+    P1 = 0x90,
+    SCON = 0x98,
+    SBUF = 0x99,
+    P2 = 0xa0,
+    IE = 0xa8,
+    P3 = 0xb0,
+    IP = 0xb8,
+    T2CON = 0xc8,
+    RCAP2L = 0xca,
+    RCAP2H = 0xcb,
+    TL2 = 0xcc,
+    TH2 = 0xcd,
+    PSW = 0xd0,
+    ACC = 0xe0,
+    B = 0xf0,
+};
+
+// 端口与外设的连接
+class Bus
+{
+public:
+    virtual ~Bus() = default;
+    virtual uint8_t Pins(int /*port*/, uint8_t latch) { return latch; } // 引脚电平 (外设线与)
+    virtual void PortWritten(int /*port*/) {}                     // 锁存器被写入
+    virtual void PortRead(int /*port*/, uint8_t /*mask*/) {}      // 程序读取引脚
+    virtual void SerialTx(uint8_t /*byte*/) {}                    // 串口发送完一个字节
+};
+
+class Cpu
+{
+public:
+    explicit Cpu(Bus& bus) : bus_(bus) { Reset(); }
+
+    std::array<uint8_t, 65536> code{};
+    std::array<uint8_t, 256> iram{};
+    uint16_t pc = 0;
+    uint64_t cycles = 0;    // 已执行的机器周期
+    uint8_t spMax = 0;      // SP 的最大值 (栈的最高处)
+    uint16_t lastPc = 0;    // 最近执行的指令地址
+    int vectored = -1;      // 最近一次响应的中断 (Step 之后读取) 没有为 -1
+    uint64_t isrCycles[6] = {}; // 每个中断 从响应到 RETI 的机器周期 (被更高优先级打断的时间不算)
+    uint64_t isrMax[6] = {};    // 其中最长的一次
+    uint64_t overruns[6] = {};  // 中断允许 溢出时标志还未被清除 (T0 T2) 这一次溢出丢失
+    uint64_t firstOverrun[6] = {}; // 第一次丢失的时间 (机器周期)
+    uint64_t t2Running = 0;     // TR2 = 1 的机器周期
+
+    void Reset()
+    {
+        sfr_.fill(0);
+        for (uint8_t p : {P0, P1, P2, P3})
+            Sfr(p) = 0xff;
+        Sfr(SP) = 0x07;
+        spMax = 0x07;
+        pc = 0;
+        active_[0] = active_[1] = false;
+        running_[0] = running_[1] = -1;
+        ended_ = -1;
+        blockIrq_ = false;
+        for (int i = 0; i < 4; ++i)
+            pins_[i] = 0xff;
+    }
+
+    uint8_t& Sfr(uint8_t addr) { return sfr_[addr - 0x80]; }
+    uint8_t Latch(int port) const { return sfr_[port << 4]; }
+    uint8_t PinsOf(int port) { return bus_.Pins(port, Latch(port)); }
+
+    // 串口接收一个字节 (按波特率移入 之后 RI 置位)
+    void SerialRx(uint8_t byte) { rxQueue_.push_back(byte); }
+
+    // 执行一条指令 (或响应一个中断) 返回机器周期
+    int Step()
+    {
+        vectored = -1;
+        int n, isr = running_[1] >= 0 ? running_[1] : running_[0]; // RETI 也算在中断中
+        if (!blockIrq_ && Interrupt())
+        {
+            n = 2; // 硬件 LCALL
+            isr = vectored;
+        }
+        else
+        {
+            blockIrq_ = false;
+            lastPc = pc;
+            n = Execute();
+        }
+        if (isr >= 0)
+            isrCycles[isr] += n;
+        if (ended_ >= 0)
+        {
+            isrMax[isr] = std::max(isrMax[isr], isrCycles[isr] - entry_[ended_]);
+            ended_ = -1;
+        }
+        Tick(n);
+        if (Sfr(SP) > spMax)
+            spMax = Sfr(SP);
+        return n;
+    }
+
+    // 外部引脚改变后调用 (INT0 边沿检测)
+    void SampleInt0()
+    {
+        bool level = PinsOf(3) & 0x04;
+        uint8_t& tcon = Sfr(TCON);
+        if (tcon & 0x01)
+        { // 下降沿触发
+            if (int0Last_ && !level)
+                tcon |= 0x02;
+        }
+        else if (!level)
+            tcon |= 0x02;
+        else
+            tcon &= ~0x02;
+        int0Last_ = level;
+    }
+
+private:
+    uint8_t& A() { return Sfr(ACC); }
+    uint8_t& Psw() { return Sfr(PSW); }
+    bool Cy() { return Psw() & 0x80; }
+    void SetCy(bool c) { Psw() = (Psw() & 0x7f) | (c ? 0x80 : 0); }
+    uint16_t Dptr() { return Sfr(DPH) << 8 | Sfr(DPL); }
+    uint8_t RegAddr(int n) { return (Psw() & 0x18) + n; }
+    uint8_t& R(int n) { return iram[RegAddr(n)]; }
+    uint8_t Fetch() { return code[pc++]; }
+
+    static int PortOf(uint8_t addr) { return (addr == P0 || addr == P1 || addr == P2 || addr == P3) ? (addr - P0) >> 4 : -1; }
+
+    uint8_t ReadDirect(uint8_t addr, bool rmw = false)
+    {
+        if (addr < 0x80)
+            return iram[addr];
+        int port = PortOf(addr);
+        if (port >= 0 && !rmw)
+        {
+            bus_.PortRead(port, 0xff);
+            return PinsOf(port);
+        }
+        if (addr == SBUF)
+            return sbufRx_;
+        if (addr == PSW)
+            return Parity();
+        return Sfr(addr);
+    }
+
+    void WriteDirect(uint8_t addr, uint8_t v)
+    {
+        if (addr < 0x80)
+        {
+            iram[addr] = v;
+            return;
+        }
+        if (addr == SBUF)
+        { // 开始发送 (起始位 8 位数据 停止位)
+            sbufTx_ = v;
+            txBits_ = 10;
+            return;
+        }
+        Sfr(addr) = v;
+        if (addr == IE || addr == IP)
+            blockIrq_ = true; // 写 IE IP 之后至少再执行一条指令
+        int port = PortOf(addr);
+        if (port >= 0)
+            bus_.PortWritten(port);
+    }
+
+    uint8_t Parity() { return (Psw() & 0xfe) | (__builtin_parity(A()) ? 1 : 0); }
+
+    static uint8_t BitByte(uint8_t bit) { return bit < 0x80 ? 0x20 + (bit >> 3) : bit & 0xf8; }
+
+    bool ReadBit(uint8_t bit, bool rmw = false)
+    {
+        uint8_t addr = BitByte(bit), mask = 1 << (bit & 7);
+        int port = addr >= 0x80 ? PortOf(addr) : -1;
+        if (port >= 0 && !rmw)
+        {
+            bus_.PortRead(port, mask);
+            return PinsOf(port) & mask;
+        }
+        return ReadDirect(addr, true) & mask;
+    }
+
+    void WriteBit(uint8_t bit, bool v)
+    {
+        uint8_t addr = BitByte(bit), mask = 1 << (bit & 7);
+        uint8_t old = ReadDirect(addr, true);
+        WriteDirect(addr, v ? old | mask : old & ~mask);
+    }
+
+    void Push(uint8_t v) { iram[++Sfr(SP)] = v; }
+    uint8_t Pop() { return iram[Sfr(SP)--]; }
+
+    void Add(uint8_t v, bool carry)
+    {
+        int a = A(), c = carry ? 1 : 0, r = a + v + c;
+        uint8_t psw = Psw() & 0x3b;
+        if (r > 0xff)
+            psw |= 0x80;
+        if ((a & 0x0f) + (v & 0x0f) + c > 0x0f)
+            psw |= 0x40;
+        if ((a ^ r) & (v ^ r) & 0x80)
+            psw |= 0x04;
+        Psw() = psw;
+        A() = static_cast<uint8_t>(r);
+    }
+
+    void Subb(uint8_t v)
+    {
+        int a = A(), c = Cy() ? 1 : 0, r = a - v - c;
+        uint8_t psw = Psw() & 0x3b;
+        if (r < 0)
+            psw |= 0x80;
+        if ((a & 0x0f) - (v & 0x0f) - c < 0)
+            psw |= 0x40;
+        if ((a ^ v) & (a ^ r) & 0x80)
+            psw |= 0x04;
+        Psw() = psw;
+        A() = static_cast<uint8_t>(r);
+    }
+
+    void Rel(uint8_t rel, bool take)
+    {
+        if (take)
+            pc = static_cast<uint16_t>(pc + static_cast<int8_t>(rel));
+    }
+
+    // 低 4 位为 4-F 的一组指令的源操作数: #imm dir @R0 @R1 R0-R7
+    uint8_t Src(uint8_t op)
+    {
+        switch (op & 0x0f)
+        {
+        case 4:
+            return Fetch();
+        case 5:
+            return ReadDirect(Fetch());
+        case 6:
+        case 7:
+            return iram[R(op & 1)];
+        default:
+            return R(op & 7);
+        }
+    }
+
+    // 低 4 位为 5-F 的一组指令的操作数地址 (直接地址 或 RAM 地址)
+    // 返回 true 为直接地址 (可能是 SFR)
+    bool Dst(uint8_t op, uint8_t& addr)
+    {
+        switch (op & 0x0f)
+        {
+        case 5:
+            addr = Fetch();
+            return true;
+        case 6:
+        case 7:
+            addr = R(op & 1);
+            return false;
+        default:
+            addr = RegAddr(op & 7);
+            return false;
+        }
+    }
+
+    uint8_t Load(bool direct, uint8_t addr, bool rmw = false) { return direct ? ReadDirect(addr, rmw) : iram[addr]; }
+    void Store(bool direct, uint8_t addr, uint8_t v)
+    {
+        if (direct)
+            WriteDirect(addr, v);
+        else
+            iram[addr] = v;
+    }
+
+    int Execute()
+    {
+        uint8_t op = Fetch();
+        const OpInfo& info = Ops()[op];
+        uint8_t a, b, addr;
+        bool direct;
+        if ((op & 0x1f) == 0x01 || (op & 0x1f) == 0x11)
+        { // AJMP ACALL
+            uint16_t target = (pc + 1) & 0xf800;
+            target |= (op >> 5) << 8 | Fetch();
+            if (op & 0x10)
+            {
+                Push(pc & 0xff);
+                Push(pc >> 8);
+            }
+            pc = target;
+            return info.cycles;
+        }
+        uint8_t lo = op & 0x0f, hi = op >> 4;
+        if (lo >= 4)
+        {
+            switch (hi)
+            {
+            case 0x0: // INC
+            case 0x1: // DEC
+                if (lo == 4)
+                    A() += hi ? -1 : 1;
+                else
+                {
+                    direct = Dst(op, addr);
+                    Store(direct, addr, Load(direct, addr, true) + (hi ? -1 : 1));
+                }
+                return info.cycles;
+            case 0x2:
+                Add(Src(op), false);
+                return info.cycles;
+            case 0x3:
+                Add(Src(op), Cy());
+                return info.cycles;
+            case 0x4:
+                A() |= Src(op);
+                return info.cycles;
+            case 0x5:
+                A() &= Src(op);
+                return info.cycles;
+            case 0x6:
+                A() ^= Src(op);
+                return info.cycles;
+            case 0x7: // MOV x,#imm
+                if (lo == 4)
+                    A() = Fetch();
+                else
+                {
+                    direct = Dst(op, addr);
+                    Store(direct, addr, Fetch());
+                }
+                return info.cycles;
+            case 0x8: // MOV dir,x
+                if (lo == 4)
+                { // DIV AB
+                    a = A();
+                    b = Sfr(B);
+                    Psw() &= 0x7b;
+                    if (!b)
+                        Psw() |= 0x04;
+                    else
+                    {
+                        A() = a / b;
+                        Sfr(B) = a % b;
+                    }
+                }
+                else if (lo == 5)
+                { // MOV dir,dir (源 目的)
+                    a = ReadDirect(Fetch());
+                    WriteDirect(Fetch(), a);
+                }
+                else
+                {
+                    direct = Dst(op, addr);
+                    a = Load(direct, addr);
+                    WriteDirect(Fetch(), a);
+                }
+                return info.cycles;
+            case 0x9:
+                Subb(Src(op));
+                return info.cycles;
+            case 0xa: // MOV x,dir
+                if (lo == 4)
+                { // MUL AB
+                    unsigned r = A() * Sfr(B);
+                    A() = r & 0xff;
+                    Sfr(B) = r >> 8;
+                    Psw() = (Psw() & 0x7b) | (r > 0xff ? 0x04 : 0);
+                }
+                else if (lo >= 6)
+                {
+                    direct = Dst(op, addr);
+                    Store(direct, addr, ReadDirect(Fetch()));
+                }
+                return info.cycles;
+            case 0xb: // CJNE
+                if (lo == 4)
+                {
+                    a = A();
+                    b = Fetch();
+                }
+                else if (lo == 5)
+                {
+                    a = A();
+                    b = ReadDirect(Fetch());
+                }
+                else
+                {
+                    direct = Dst(op, addr);
+                    a = iram[addr];
+                    b = Fetch();
+                }
+                SetCy(a < b);
+                Rel(Fetch(), a != b);
+                return info.cycles;
+            case 0xc: // XCH
+                if (lo == 4)
+                    A() = static_cast<uint8_t>(A() << 4 | A() >> 4); // SWAP
+                else
+                {
+                    direct = Dst(op, addr);
+                    a = Load(direct, addr);
+                    Store(direct, addr, A());
+                    A() = a;
+                }
+                return info.cycles;
+            case 0xd:
+                if (lo == 4)
+                { // DA A
+                    unsigned v = A();
+                    if ((v & 0x0f) > 9 || (Psw() & 0x40))
+                        v += 6;
+                    if (v > 0xff)
+                        SetCy(true);
+                    if (((v >> 4) & 0x1f) > 9 || Cy())
+                    {
+                        v += 0x60;
+                        SetCy(true);
+                    }
+                    A() = v & 0xff;
+                }
+                else if (lo == 6 || lo == 7)
+                { // XCHD
+                    addr = R(lo & 1);
+                    a = iram[addr];
+                    iram[addr] = (a & 0xf0) | (A() & 0x0f);
+                    A() = (A() & 0xf0) | (a & 0x0f);
+                }
+                else
+                { // DJNZ
+                    direct = Dst(op, addr);
+                    a = Load(direct, addr, true) - 1;
+                    Store(direct, addr, a);
+                    Rel(Fetch(), a != 0);
+                }
+                return info.cycles;
+            case 0xe: // MOV A,x
+                if (lo == 4)
+                    A() = 0;
+                else
+                    A() = Src(op);
+                return info.cycles;
+            case 0xf: // MOV x,A
+                if (lo == 4)
+                    A() = ~A();
+                else
+                {
+                    direct = Dst(op, addr);
+                    Store(direct, addr, A());
+                }
+                return info.cycles;
+            }
+        }
+        switch (op)
+        {
+        case 0x00:
+            break;
+        case 0x02:
+            a = Fetch();
+            pc = a << 8 | Fetch();
+            break;
+        case 0x12: {
+            a = Fetch();
+            b = Fetch();
+            Push(pc & 0xff);
+            Push(pc >> 8);
+            pc = a << 8 | b;
+            break;
+        }
+        case 0x03:
+            A() = static_cast<uint8_t>(A() >> 1 | A() << 7);
+            break;
+        case 0x13: {
+            bool c = A() & 1;
+            A() = static_cast<uint8_t>(A() >> 1 | (Cy() ? 0x80 : 0));
+            SetCy(c);
+            break;
+        }
+        case 0x23:
+            A() = static_cast<uint8_t>(A() << 1 | A() >> 7);
+            break;
+        case 0x33: {
+            bool c = A() & 0x80;
+            A() = static_cast<uint8_t>(A() << 1 | (Cy() ? 1 : 0));
+            SetCy(c);
+            break;
+        }
+        case 0x10: { // JBC
+            uint8_t bit = Fetch(), rel = Fetch();
+            if (ReadBit(bit, true))
+            {
+                WriteBit(bit, false);
+                Rel(rel, true);
+            }
+            break;
+        }
+        case 0x20:
+        case 0x30: {
+            uint8_t bit = Fetch(), rel = Fetch();
+            Rel(rel, ReadBit(bit) == (op == 0x20));
+            break;
+        }
+        case 0x22:
+        case 0x32:
+            a = Pop();
+            pc = a << 8 | Pop();
+            if (op == 0x32)
+            { // 结束优先级较高的那一个
+                int level = active_[1] ? 1 : 0;
+                active_[level] = false;
+                running_[level] = -1;
+                ended_ = level;
+                blockIrq_ = true;
+            }
+            break;
+        case 0x40:
+        case 0x50:
+            Rel(Fetch(), Cy() == (op == 0x40));
+            break;
+        case 0x60:
+        case 0x70:
+            Rel(Fetch(), (A() == 0) == (op == 0x60));
+            break;
+        case 0x80:
+            Rel(Fetch(), true);
+            break;
+        case 0x42:
+        case 0x52:
+        case 0x62:
+        case 0x43:
+        case 0x53:
+        case 0x63: { // ORL ANL XRL dir,A / dir,#imm (读锁存器)
+            addr = Fetch();
+            b = (op & 1) ? Fetch() : A();
+            a = ReadDirect(addr, true);
+            a = hi == 4 ? a | b : hi == 5 ? a & b : a ^ b;
+            WriteDirect(addr, a);
+            break;
+        }
+        case 0x72:
+            SetCy(Cy() | ReadBit(Fetch()));
+            break;
+        case 0xa0:
+            SetCy(Cy() | !ReadBit(Fetch()));
+            break;
+        case 0x82:
+            SetCy(Cy() & ReadBit(Fetch()));
+            break;
+        case 0xb0:
+            SetCy(Cy() & !ReadBit(Fetch()));
+            break;
+        case 0x73:
+            pc = static_cast<uint16_t>(Dptr() + A());
+            break;
+        case 0x83:
+            A() = code[static_cast<uint16_t>(pc + A())];
+            break;
+        case 0x93:
+            A() = code[static_cast<uint16_t>(Dptr() + A())];
+            break;
+        case 0x90:
+            Sfr(DPH) = Fetch();
+            Sfr(DPL) = Fetch();
+            break;
+        case 0x92:
+            WriteBit(Fetch(), Cy());
+            break;
+        case 0xa2:
+            SetCy(ReadBit(Fetch()));
+            break;
+        case 0xa3: {
+            uint16_t d = Dptr() + 1;
+            Sfr(DPH) = d >> 8;
+            Sfr(DPL) = d & 0xff;
+            break;
+        }
+        case 0xb2: {
+            uint8_t bit = Fetch();
+            WriteBit(bit, !ReadBit(bit, true));
+            break;
+        }
+        case 0xb3:
+            SetCy(!Cy());
+            break;
+        case 0xc0:
+            Push(ReadDirect(Fetch()));
+            break;
+        case 0xd0:
+            a = Pop();
+            WriteDirect(Fetch(), a);
+            break;
+        case 0xc2:
+        case 0xd2:
+            WriteBit(Fetch(), op == 0xd2);
+            break;
+        case 0xc3:
+        case 0xd3:
+            SetCy(op == 0xd3);
+            break;
+        case 0xe0:
+        case 0xe2:
+        case 0xe3:
+            A() = 0xff; // 没有外部 RAM
+            break;
+        case 0xf0:
+        case 0xf2:
+        case 0xf3:
+            break;
+        default: // 0xa5
+            break;
+        }
+        return info.cycles;
+    }
+
+    // 响应中断 (在指令之间) 返回是否响应
+    bool Interrupt()
+    {
+        uint8_t ie = Sfr(IE);
+        if (!(ie & 0x80) || active_[1])
+            return false;
+        uint8_t tcon = Sfr(TCON), scon = Sfr(SCON), t2con = Sfr(T2CON);
+        bool req[6] = {(tcon & 0x02) != 0, (tcon & 0x20) != 0, (tcon & 0x08) != 0,
+                       (tcon & 0x80) != 0, (scon & 0x03) != 0, (t2con & 0xc0) != 0};
+        for (int level = 1; level >= 0; --level)
+        {
+            if (level == 0 && active_[0])
+                return false;
+            for (int i = 0; i < 6; ++i)
+            {
+                if (!req[i] || !(ie & (1 << i)) || ((Sfr(IP) >> i) & 1) != level)
+                    continue;
+                // 硬件清除的标志
+                if (i == 0 && (tcon & 0x01))
+                    Sfr(TCON) &= ~0x02;
+                else if (i == 1)
+                    Sfr(TCON) &= ~0x20;
+                else if (i == 2 && (tcon & 0x04))
+                    Sfr(TCON) &= ~0x08;
+                else if (i == 3)
+                    Sfr(TCON) &= ~0x80;
+                active_[level] = true;
+                running_[level] = i;
+                entry_[level] = isrCycles[i];
+                lastPc = pc;
+                Push(pc & 0xff);
+                Push(pc >> 8);
+                pc = static_cast<uint16_t>(i * 8 + 3);
+                vectored = i;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void Tick(int n)
+    {
+        for (; n; --n)
+        {
+            ++cycles;
+            uint8_t tcon = Sfr(TCON), tmod = Sfr(TMOD);
+            if (tcon & 0x10)
+                CountTimer(tmod & 3, Sfr(TL0), Sfr(TH0), 0x20);
+            if (tcon & 0x40 && CountTimer((tmod >> 4) & 3, Sfr(TL1), Sfr(TH1), 0x80))
+                BaudTick();
+            if (Sfr(T2CON) & 0x04)
+            {
+                ++t2Running;
+                if (!++Sfr(TL2) && !++Sfr(TH2))
+                {
+                    Sfr(TL2) = Sfr(RCAP2L);
+                    Sfr(TH2) = Sfr(RCAP2H);
+                    if ((Sfr(T2CON) & 0x80) && (Sfr(IE) & 0x20) && !overruns[5]++)
+                        firstOverrun[5] = cycles;
+                    Sfr(T2CON) |= 0x80;
+                }
+            }
+        }
+    }
+
+    // 返回是否溢出
+    bool CountTimer(int mode, uint8_t& tl, uint8_t& th, uint8_t flag)
+    {
+        bool over = false;
+        switch (mode)
+        {
+        case 0: // 13 位
+            tl = (tl + 1) & 0x1f;
+            over = !tl && !++th;
+            break;
+        case 1:
+            over = !++tl && !++th;
+            break;
+        case 2:
+            if (!++tl)
+            {
+                tl = th;
+                over = true;
+            }
+            break;
+        default:
+            break;
+        }
+        if (over)
+        {
+            if (flag == 0x20 && (Sfr(TCON) & flag) && (Sfr(IE) & 0x02) && !overruns[1]++)
+                firstOverrun[1] = cycles;
+            Sfr(TCON) |= flag;
+        }
+        return over;
+    }
+
+    // T1 溢出: 串口方式1 每 32 (SMOD=1 时 16) 次溢出一位
+    void BaudTick()
+    {
+        if (++baudDiv_ < ((Sfr(PCON) & 0x80) ? 16 : 32))
+            return;
+        baudDiv_ = 0;
+        if (txBits_ && !--txBits_)
+        {
+            Sfr(SCON) |= 0x02; // TI
+            bus_.SerialTx(sbufTx_);
+        }
+        if (!rxBits_ && !rxQueue_.empty())
+            rxBits_ = 10;
+        else if (rxBits_ && !--rxBits_)
+        {
+            uint8_t byte = rxQueue_.front();
+            rxQueue_.pop_front();
+            if ((Sfr(SCON) & 0x10) && !(Sfr(SCON) & 0x01))
+            { // REN 且上一个字节已取走
+                sbufRx_ = byte;
+                Sfr(SCON) |= 0x01;
+            }
+        }
+    }
+
+    Bus& bus_;
+    std::array<uint8_t, 128> sfr_{};
+    bool active_[2] = {false, false}; // 正在服务的 低/高 优先级中断
+    int running_[2] = {-1, -1};       // 以上两个中断的编号
+    uint64_t entry_[2] = {};          // 响应时的 isrCycles
+    int ended_ = -1;                  // 刚执行的 RETI 结束的优先级
+    bool blockIrq_ = false;
+    bool int0Last_ = true;
+    uint8_t pins_[4] = {};
+    uint8_t sbufTx_ = 0, sbufRx_ = 0;
+    int txBits_ = 0, rxBits_ = 0, baudDiv_ = 0;
+    std::deque<uint8_t> rxQueue_;
+};
+
+} // namespace i8051
+
+#endif // I8051_H
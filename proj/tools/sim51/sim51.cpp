@@ -0,0 +1,1539 @@
+/**
+ * sim51.cpp
+ * ----------------------------------------------
+ * 主机端工具: 在指令级仿真器 (i8051.h) 上运行固件的 HEX 文件
+ * 记录引脚波形 (VCD 用 GTKWave 或 PulseView 打开) 并按器件手册检查总线时序
+ *
+ * 编译: g++ -std=c++17 -O2 -o sim51 sim51.cpp
+ * 用法: sim51 [-t 秒] [-c 晶振MHz] [-v out.vcd] [-u uart.bin] [-s 栈余量] [-n] [-p __config__.h]
+ *             [-k script.txt] [-e eeprom.bin] Ultimate.hex
+ *   -t 仿真时间 默认 2s
+ *   -v 输出所有端口与总线引脚的波形 (时间单位 ns)
+ *   -u 保存串口发送的字节 (可交给 trace2json)
+ *   -s 栈最少剩余的字节数 (最高 SP 到 0xff) 不足时失败
+ *   -n 时序违例和丢失的 T0 节拍只报告 不返回 1 (在已知有这些问题的旧 HEX 上只检查栈和 expect)
+ *   -p 从配置文件读取引脚 (LCD1602_DEFINE_RS 等) 默认与仓库中的 __config__.h 相同
+ * 中断: 每个中断的次数 平均/最长的机器周期 (不含打断它的高优先级中断) CPU 占用 T2 另按 TR2 = 1 的时间计算
+ *       T0 T2 允许中断时 溢出时标志还未清除即为丢失 (T0 丢失节拍)
+ * 任一时序检查失败 栈余量不足 或丢失 T0 节拍时返回 1 (-n 时只有栈余量不足)
+ *
+ * 时序检查 (只看单片机自己驱动的锁存器 器件的应答不算):
+ *   1-Wire (DS18B20):  复位低 >= 480us  复位后 60~75us 内采样存在脉冲  复位恢复 >= 480us
+ *                      写1/读 拉低 1~15us  写0 拉低 60~120us  读采样在下降沿后 15us 内
+ *                      时隙 >= 61us  恢复 >= 1us
+ *   I2C (AT24C02 100kHz):  tHIGH >= 4.0  tLOW >= 4.7  tSU.STA >= 4.7  tHD.STA >= 4.0
+ *                          tSU.STO >= 4.0  tBUF >= 4.7  tSU.DAT >= 0.25 (us)
+ *                          字节中间 SCL 为高时 SDA 改变 (意外的 START/STOP)
+ *   LCD1602 (HD44780):  tAS >= 40ns  PWEH >= 230ns  tcycE >= 500ns  tDSW >= 80ns  保持 > 0
+ *                       两次写之间没有查询忙标志时 间隔 >= 37us (清屏/归位之后 1.52ms)
+ * 吞吐量: 每条总线 传输的字节数 / 活动时间 (相邻事件间隔小于空闲阈值的时间之和)
+ *
+ * 器件模型 (按 __config__.h 的引脚连接):
+ *   DS18B20  暂存器 转换延时 (-k 脚本中 convert) 温度由脚本注入 (temp)
+ *   AT24C02  页内地址回绕 STOP 后 5ms 写周期中不应答 -e 读入 256 字节的初始镜像 (eepromc -b)
+ *   LCD1602  按 lcd1602.h 中的命令维护 DDRAM 显示为 2x16 的文字 (结束时打印)
+ *   按键     P3.4-P3.7 与 INT0 (P3.2) 由脚本按下 脚本格式见 Script
+ * 脚本中的 expect eecheck 失败时同样返回 1
+ */
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "i8051.h"
+
+namespace {
+
+struct Pin
+{
+    int port = -1;
+    int bit = -1; // -1 为整个端口
+
+    bool Valid() const { return port >= 0; }
+    uint8_t Mask() const { return bit < 0 ? 0xff : static_cast<uint8_t>(1 << bit); }
+};
+
+// 引脚配置 与 __config__.h 中的名称相同
+struct Config
+{
+    std::map<std::string, Pin> pins = {
+        {"LCD1602_DATA", {0, -1}},      {"LCD1602_DEFINE_RS", {1, 0}}, {"LCD1602_DEFINE_RW", {1, 1}},
+        {"LCD1602_DEFINE_EN", {1, 2}},  {"DS18B20_DEFINE_DQ", {1, 5}}, {"I2C_DEFINE_SDA", {1, 7}},
+        {"I2C_DEFINE_SCL", {1, 6}},     {"KEYS", {3, -1}},             {"DEFINE_DCM", {2, 7}},
+        {"DEFINE_RELAY", {2, 3}},       {"DEFINE_BUZZER", {1, 4}},
+    };
+
+    Pin operator[](const std::string& name) const { return pins.at(name); }
+
+    bool Load(const std::string& path)
+    {
+        std::ifstream in(path);
+        if (!in)
+            return false;
+        static const std::regex def(R"(^\s*#define\s+(\w+)\s+P([0-3])\s*(\^\s*([0-7]))?\s*(//.*)?$)");
+        std::string line;
+        std::smatch m;
+        while (std::getline(in, line))
+        {
+            if (!std::regex_match(line, m, def) || !pins.count(m[1]))
+                continue;
+            pins[m[1]] = {m[2].str()[0] - '0', m[4].matched ? m[4].str()[0] - '0' : -1};
+        }
+        return true;
+    }
+};
+
+bool LoadHex(const std::string& path, i8051::Cpu& cpu, unsigned& top)
+{
+    std::ifstream in(path);
+    if (!in)
+        return false;
+    std::string line;
+    unsigned base = 0;
+    top = 0;
+    while (std::getline(in, line))
+    {
+        if (line.empty() || line[0] != ':')
+            continue;
+        auto byte = [&line](size_t i) { return static_cast<unsigned>(std::stoul(line.substr(1 + i * 2, 2), nullptr, 16)); };
+        unsigned n = byte(0), addr = byte(1) << 8 | byte(2), type = byte(3), sum = 0;
+        for (unsigned i = 0; i < n + 5; ++i)
+            sum += byte(i);
+        if (sum & 0xff)
+            return false;
+        if (type == 1)
+            break;
+        if (type == 2)
+            base = (byte(4) << 8 | byte(5)) << 4;
+        else if (type == 0)
+            for (unsigned i = 0; i < n; ++i)
+            {
+                unsigned a = base + addr + i;
+                if (a < cpu.code.size())
+                    cpu.code[a] = static_cast<uint8_t>(byte(4 + i));
+                top = std::max(top, a + 1);
+            }
+    }
+    return true;
+}
+
+// ------------------------------------------------------------------
+// 时间 以机器周期计 输出换算为 us
+
+double g_cycleNs = 12000.0 / 11.0592;
+
+double Us(uint64_t cycles) { return cycles * g_cycleNs / 1000; }
+
+uint64_t Cycles(double us) { return static_cast<uint64_t>(std::llround(us * 1000 / g_cycleNs)); }
+
+// 一项时序检查的统计
+class Limit
+{
+public:
+    Limit(const char* name, double min, double max = INFINITY) : name_(name), min_(min), max_(max) {}
+
+    void Add(double us, uint64_t t)
+    {
+        ++count_;
+        lo_ = std::min(lo_, us);
+        hi_ = std::max(hi_, us);
+        if (us < min_ || us > max_)
+        {
+            if (!bad_++)
+                first_ = t;
+        }
+    }
+
+    // 非数值的违例 (协议错误)
+    void Fail(uint64_t t)
+    {
+        ++count_;
+        if (!bad_++)
+            first_ = t;
+    }
+
+    uint64_t Bad() const { return bad_; }
+
+    void Print() const
+    {
+        if (!count_)
+        {
+            std::printf("  %-22s      -\n", name_);
+            return;
+        }
+        char range[48] = "";
+        if (std::isfinite(max_))
+            std::snprintf(range, sizeof(range), "%g~%g", min_, max_);
+        else if (min_ > 0)
+            std::snprintf(range, sizeof(range), ">= %g", min_);
+        std::printf("  %-22s %6llu", name_, static_cast<unsigned long long>(count_));
+        if (lo_ <= hi_)
+            std::printf("  %9.3f %9.3f  %-10s", lo_, hi_, range);
+        else
+            std::printf("  %31s", "");
+        if (bad_)
+            std::printf("  FAIL %llu (first at %.3f ms)\n", static_cast<unsigned long long>(bad_), Us(first_) / 1000);
+        else
+            std::printf("  ok\n");
+    }
+
+private:
+    const char* name_;
+    double min_, max_;
+    uint64_t count_ = 0, bad_ = 0, first_ = 0;
+    double lo_ = INFINITY, hi_ = -INFINITY;
+};
+
+// 活动时间: 相邻两个事件的间隔小于 idle 时计入
+class Activity
+{
+public:
+    explicit Activity(double idleUs) : idle_(idleUs) {}
+
+    void Mark(uint64_t t)
+    {
+        if (seen_ && Us(t - last_) < idle_)
+            active_ += t - last_;
+        seen_ = true;
+        last_ = t;
+    }
+
+    void Print(const char* bus, uint64_t bytes) const
+    {
+        double us = Us(active_);
+        std::printf("  %-8s %8llu bytes  active %10.3f ms", bus, static_cast<unsigned long long>(bytes), us / 1000);
+        if (us > 0 && bytes)
+            std::printf("  %8.2f kB/s  %7.2f us/byte", bytes / us * 1000, us / bytes);
+        std::printf("\n");
+    }
+
+private:
+    double idle_;
+    bool seen_ = false;
+    uint64_t last_ = 0, active_ = 0;
+};
+
+// 观察单片机驱动的引脚
+class Probe
+{
+public:
+    virtual ~Probe() = default;
+    virtual void Edge(const Pin& pin, bool level, uint64_t t) = 0; // 锁存器的一位改变
+    virtual void Bus(int /*port*/, uint8_t /*latch*/, uint64_t /*t*/) {} // 端口的锁存器改变 (整个字节)
+    virtual void Read(int /*port*/, uint8_t /*mask*/, uint8_t /*pins*/, uint64_t /*t*/) {}
+    virtual void Report() const = 0;
+    virtual uint64_t Violations() const = 0;
+};
+
+// 端口上的器件
+class Device
+{
+public:
+    virtual ~Device() = default;
+    // 锁存器的一位改变 latch 为改变之后四个端口的锁存器
+    virtual void Edge(const Pin& /*pin*/, bool /*level*/, const uint8_t* /*latch*/, uint64_t /*t*/) {}
+    // 器件在端口上驱动的电平 (1 为释放) t 为当前时刻
+    virtual uint8_t Drive(int /*port*/, const uint8_t* /*latch*/, uint64_t /*t*/) { return 0xff; }
+    virtual void Report() const {}
+};
+
+bool Same(const Pin& a, const Pin& b) { return a.port == b.port && a.bit == b.bit; }
+
+bool High(const uint8_t* latch, const Pin& p) { return latch[p.port] & p.Mask(); }
+
+// ------------------------------------------------------------------
+
+class OneWireCheck : public Probe
+{
+public:
+    explicit OneWireCheck(Pin dq) : dq_(dq) {}
+
+    void Edge(const Pin& pin, bool level, uint64_t t) override
+    {
+        if (pin.port != dq_.port || pin.bit != dq_.bit)
+            return;
+        act_.Mark(t);
+        if (!level)
+        {
+            if (afterReset_)
+                rsth_.Add(Us(t - rise_), t);
+            else if (slotStart_)
+            {
+                slot_.Add(Us(t - fall_), t);
+                recovery_.Add(Us(t - rise_), t);
+            }
+            fall_ = t;
+            sampled_ = afterReset_ = slotStart_ = false;
+            return;
+        }
+        rise_ = t;
+        double low = Us(t - fall_);
+        if (low > 120 + 40)
+        { // 复位
+            reset_.Add(low, t);
+            afterReset_ = true;
+            presence_ = true;
+            return;
+        }
+        slotStart_ = true;
+        ++bits_;
+        if (low < 45) // 按较近的一类检查 (写1/读 或 写0)
+            short_.Add(low, t);
+        else
+            zero_.Add(low, t);
+    }
+
+    void Read(int port, uint8_t mask, uint8_t, uint64_t t) override
+    {
+        if (port != dq_.port || !(mask & dq_.Mask()) || sampled_)
+            return;
+        sampled_ = true;
+        if (presence_ && afterReset_)
+        {
+            presence_ = false;
+            sample_.Add(Us(t - rise_), t);
+        }
+        else if (slotStart_)
+            read_.Add(Us(t - fall_), t);
+    }
+
+    void Report() const override
+    {
+        std::printf("1-Wire (DS18B20)                n       min       max  limit(us)\n");
+        for (const Limit* l : {&reset_, &sample_, &rsth_, &short_, &zero_, &read_, &slot_, &recovery_})
+            l->Print();
+    }
+
+    uint64_t Violations() const override
+    {
+        return reset_.Bad() + sample_.Bad() + rsth_.Bad() + short_.Bad() + zero_.Bad() + read_.Bad() + slot_.Bad() +
+               recovery_.Bad();
+    }
+
+    void Throughput() const { act_.Print("1-Wire", bits_ / 8); }
+
+private:
+    Pin dq_;
+    uint64_t fall_ = 0, rise_ = 0, bits_ = 0;
+    bool afterReset_ = false, presence_ = false, slotStart_ = false, sampled_ = false;
+    Limit reset_{"reset low", 480};
+    Limit sample_{"presence sample", 60, 75};
+    Limit rsth_{"reset recovery", 480};
+    Limit short_{"write1/read low", 1, 15};
+    Limit zero_{"write0 low", 60, 120};
+    Limit read_{"read sample", 0, 15};
+    Limit slot_{"slot", 61};
+    Limit recovery_{"recovery", 1};
+    Activity act_{1000};
+};
+
+class I2CCheck : public Probe
+{
+public:
+    I2CCheck(Pin scl, Pin sda) : scl_(scl), sda_(sda) {}
+
+    void Edge(const Pin& pin, bool level, uint64_t t) override
+    {
+        bool isScl = pin.port == scl_.port && pin.bit == scl_.bit;
+        bool isSda = pin.port == sda_.port && pin.bit == sda_.bit;
+        if (!isScl && !isSda)
+            return;
+        if (inFrame_)
+            act_.Mark(t);
+        if (isScl)
+        {
+            if (level)
+            {
+                if (inFrame_ && sdaAt_ > sclAt_)
+                    suDat_.Add(Us(t - sdaAt_), t);
+                if (inFrame_ && !start_)
+                    low_.Add(Us(t - sclAt_), t);
+            }
+            else if (inFrame_)
+            {
+                if (start_)
+                    hdSta_.Add(Us(t - sdaAt_), t);
+                else
+                { // 一个时钟 (STOP 之前的上升沿没有下降沿 不计)
+                    high_.Add(Us(t - sclAt_), t);
+                    ++clocks_;
+                }
+                start_ = false;
+            }
+            sclHigh_ = level;
+            sclAt_ = t;
+            return;
+        }
+        if (sclHigh_)
+        { // SCL 为高时 SDA 改变: START 或 STOP
+            if (inFrame_ && clocks_ % 9)
+                glitch_.Fail(t);
+            if (!level)
+            {
+                if (inFrame_)
+                    suSta_.Add(Us(t - sclAt_), t);
+                else if (stopped_)
+                    buf_.Add(Us(t - stopAt_), t);
+                inFrame_ = start_ = true;
+                act_.Mark(t);
+                clocks_ = 0;
+            }
+            else if (inFrame_)
+            {
+                suSto_.Add(Us(t - sclAt_), t);
+                bytes_ += clocks_ / 9;
+                inFrame_ = false;
+                stopped_ = true;
+                stopAt_ = t;
+            }
+        }
+        sdaAt_ = t;
+    }
+
+    void Report() const override
+    {
+        std::printf("I2C (AT24C02)                   n       min       max  limit(us)\n");
+        for (const Limit* l : {&high_, &low_, &suSta_, &hdSta_, &suSto_, &buf_, &suDat_, &glitch_})
+            l->Print();
+    }
+
+    uint64_t Violations() const override
+    {
+        return high_.Bad() + low_.Bad() + suSta_.Bad() + hdSta_.Bad() + suSto_.Bad() + buf_.Bad() + suDat_.Bad() +
+               glitch_.Bad();
+    }
+
+    void Throughput() const { act_.Print("I2C", bytes_ + (inFrame_ ? clocks_ / 9 : 0)); }
+
+private:
+    Pin scl_, sda_;
+    bool sclHigh_ = true, inFrame_ = false, start_ = false, stopped_ = false;
+    uint64_t sclAt_ = 0, sdaAt_ = 0, stopAt_ = 0, clocks_ = 0, bytes_ = 0;
+    Limit high_{"tHIGH", 4.0};
+    Limit low_{"tLOW", 4.7};
+    Limit suSta_{"tSU.STA", 4.7};
+    Limit hdSta_{"tHD.STA", 4.0};
+    Limit suSto_{"tSU.STO", 4.0};
+    Limit buf_{"tBUF", 4.7};
+    Limit suDat_{"tSU.DAT", 0.25};
+    Limit glitch_{"START/STOP mid-byte", 0};
+    Activity act_{1000};
+};
+
+class LcdCheck : public Probe
+{
+public:
+    LcdCheck(Pin rs, Pin rw, Pin en, Pin data) : rs_(rs), rw_(rw), en_(en), data_(data) {}
+
+    void Edge(const Pin& pin, bool level, uint64_t t) override
+    {
+        if (Same(pin, rs_) || Same(pin, rw_))
+        {
+            if (t == enFall_)
+                hold_.Fail(t); // 与 EN 的下降沿在同一条指令中改变
+            ctrlAt_ = t;
+            (Same(pin, rs_) ? rs : rw) = level;
+            return;
+        }
+        if (!Same(pin, en_))
+            return;
+        if (level)
+        {
+            as_.Add(Us(t - ctrlAt_) * 1000, t);
+            if (enRise_)
+                cyc_.Add(Us(t - enRise_) * 1000, t);
+            enRise_ = t;
+            en = true;
+            return;
+        }
+        en = false;
+        enFall_ = t;
+        pw_.Add(Us(t - enRise_) * 1000, t);
+        if (rw)
+            return;
+        // 写入: 数据在 EN 下降前建立 上一次写入后查询过忙标志或等待足够的时间
+        dsw_.Add(Us(t - dataAt_) * 1000, t);
+        if (writes_ && !polled_)
+        {
+            ++unpolled_;
+            if (Us(t - lastWrite_) < need_)
+            {
+                if (!early_++)
+                    earlyAt_ = t;
+            }
+        }
+        ++writes_;
+        act_.Mark(t);
+        lastWrite_ = t;
+        polled_ = false;
+        need_ = (!rs && (value_ == 0x01 || (value_ & 0xfe) == 0x02)) ? 1520 : 37;
+    }
+
+    void Bus(int port, uint8_t latch, uint64_t t) override
+    {
+        if (port != data_.port)
+            return;
+        if (t == enFall_)
+            hold_.Fail(t);
+        dataAt_ = t;
+        value_ = latch;
+    }
+
+    void Read(int port, uint8_t, uint8_t, uint64_t t) override
+    {
+        if (port != data_.port || !en || !rw)
+            return;
+        if (!rs)
+            polled_ = true;
+        ++reads_;
+        act_.Mark(t);
+    }
+
+    void Report() const override
+    {
+        std::printf("LCD1602 (HD44780)               n       min       max  limit(ns)\n");
+        for (const Limit* l : {&as_, &pw_, &cyc_, &dsw_, &hold_})
+            l->Print();
+        std::printf("  %-22s %6llu  %-31s", "write without busy", static_cast<unsigned long long>(unpolled_),
+                    "  (needs 37us / 1.52ms)");
+        if (early_)
+            std::printf("  FAIL %llu (first at %.3f ms)\n", static_cast<unsigned long long>(early_),
+                        Us(earlyAt_) / 1000);
+        else
+            std::printf("  ok\n");
+    }
+
+    uint64_t Violations() const override
+    {
+        return as_.Bad() + pw_.Bad() + cyc_.Bad() + dsw_.Bad() + hold_.Bad() + early_;
+    }
+
+    void Throughput() const { act_.Print("LCD", writes_ + reads_); }
+
+private:
+    Pin rs_, rw_, en_, data_;
+    uint8_t value_ = 0xff;
+    bool rs = true, rw = true, en = false, polled_ = false;
+    uint64_t ctrlAt_ = 0, dataAt_ = 0, enRise_ = 0, enFall_ = ~0ull, lastWrite_ = 0;
+    uint64_t writes_ = 0, reads_ = 0, unpolled_ = 0, early_ = 0, earlyAt_ = 0;
+    double need_ = 0;
+    Limit as_{"tAS", 40};
+    Limit pw_{"PWEH", 230};
+    Limit cyc_{"tcycE", 500};
+    Limit dsw_{"tDSW", 80};
+    Limit hold_{"hold (tAH tH)", 0};
+    Activity act_{2000};
+};
+
+// LCD1602 (HD44780) 8 位接口 2 行: 命令见 lcd1602.h
+// 执行命令期间忙 (清屏/归位 1.52ms 其他 37us) 忙时的写入被忽略并计数
+class Hd44780 : public Device
+{
+public:
+    Hd44780(Pin rs, Pin rw, Pin en, Pin data) : rs_(rs), rw_(rw), en_(en), data_(data) { ddram_.fill(' '); }
+
+    void Edge(const Pin& pin, bool level, const uint8_t* latch, uint64_t t) override
+    {
+        if (!Same(pin, en_) || level)
+            return;
+        bool rs = High(latch, rs_);
+        if (High(latch, rw_))
+        { // 读数据之后地址计数器移动
+            if (rs)
+                Step(1);
+            return;
+        }
+        if (t < busyUntil_)
+        {
+            ++ignored_;
+            return;
+        }
+        uint8_t v = latch[data_.port];
+        busyUntil_ = t + Cycles(37);
+        if (rs)
+        {
+            ++writes_;
+            if (cg_)
+                cgram_[ac_ & 0x3f] = v;
+            else
+                ddram_[Index(ac_)] = v;
+            Step(1);
+            if (shift_)
+                offset_ += increment_ ? 1 : -1;
+            return;
+        }
+        ++commands_;
+        if (v & 0x80)
+        {
+            cg_ = false;
+            ac_ = v & 0x7f;
+        }
+        else if (v & 0x40)
+        {
+            cg_ = true;
+            ac_ = v & 0x3f;
+        }
+        else if (v & 0x20)
+            twoLines_ = v & 0x08; // 只支持 8 位接口
+        else if (v & 0x10)
+        {
+            if (v & 0x08)
+                offset_ += (v & 0x04) ? -1 : 1; // 屏幕右移 内容向右 第 0 列的地址减小
+            else
+                Step((v & 0x04) ? 1 : 0);
+        }
+        else if (v & 0x08)
+            on_ = v & 0x04;
+        else if (v & 0x04)
+        {
+            increment_ = v & 0x02;
+            shift_ = v & 0x01;
+        }
+        else if (v & 0x03)
+        {
+            if (v & 0x01)
+            {
+                ddram_.fill(' ');
+                increment_ = true;
+            }
+            cg_ = false;
+            ac_ = 0;
+            offset_ = 0;
+            busyUntil_ = t + Cycles(1520);
+        }
+    }
+
+    uint8_t Drive(int port, const uint8_t* latch, uint64_t t) override
+    {
+        if (port != data_.port || !High(latch, en_) || !High(latch, rw_))
+            return 0xff;
+        if (High(latch, rs_))
+            return cg_ ? cgram_[ac_ & 0x3f] : ddram_[Index(ac_)];
+        return (t < busyUntil_ ? 0x80 : 0) | ac_;
+    }
+
+    // 屏幕上的一行 (16 列) 自定义字符显示为 '*' 字库中的箭头和度数转为 UTF-8
+    std::string Row(int row) const
+    {
+        std::string s;
+        for (int col = 0; col < 16; ++col)
+        {
+            uint8_t c = on_ ? ddram_[row * 40 + ((col + offset_) % 40 + 40) % 40] : ' ';
+            if (c < 0x08)
+                s += '*';
+            else if (c == 0xdf)
+                s += "°";
+            else if (c == 0x7e)
+                s += "→";
+            else if (c == 0x7f)
+                s += "←";
+            else
+                s += (c >= 0x20 && c < 0x7f) ? static_cast<char>(c) : '?';
+        }
+        return s;
+    }
+
+    void Print(uint64_t t) const
+    {
+        std::printf("[%9.3f s] LCD\n  +----------------+\n  |%s|\n  |%s|\n  +----------------+\n", Us(t) / 1e6,
+                    Row(0).c_str(), Row(1).c_str());
+    }
+
+    void Report() const override
+    {
+        std::printf("  LCD      %llu commands  %llu data  %llu ignored while busy\n",
+                    static_cast<unsigned long long>(commands_), static_cast<unsigned long long>(writes_),
+                    static_cast<unsigned long long>(ignored_));
+    }
+
+private:
+    // DDRAM 地址 0x00-0x27 0x40-0x67 对应 ddram_ 的 0-79
+    int Index(uint8_t ac) const { return (ac & 0x40 ? 40 : 0) + (ac & 0x3f) % 40; }
+
+    void Step(bool forward)
+    {
+        if (cg_)
+        {
+            ac_ = (ac_ + (forward ? 1 : -1)) & 0x3f;
+            return;
+        }
+        int i = (Index(ac_) + (forward ? 1 : 79)) % 80;
+        if (!twoLines_)
+            i %= 40;
+        ac_ = static_cast<uint8_t>(i < 40 ? i : 0x40 + i - 40);
+    }
+
+    Pin rs_, rw_, en_, data_;
+    std::array<uint8_t, 80> ddram_{};
+    std::array<uint8_t, 64> cgram_{};
+    uint8_t ac_ = 0;
+    int offset_ = 0;
+    bool cg_ = false, increment_ = true, shift_ = false, on_ = false, twoLines_ = true;
+    uint64_t busyUntil_ = 0, commands_ = 0, writes_ = 0, ignored_ = 0;
+};
+
+// DS18B20 (跳过 ROM 的单个器件): 暂存器 9 字节 (带 CRC) 转换温度 读写暂存器 复制/恢复 EEPROM
+// 复位后等 30us 拉低 120us 作为存在脉冲 读时隙中发送 0 时从下降沿起拉低 30us
+// 写时隙中 在下降沿后 30us 采样 (低电平短于 30us 为 1)
+class Ds18b20 : public Device
+{
+public:
+    explicit Ds18b20(Pin dq) : dq_(dq)
+    {
+        pad_ = {0x50, 0x05, 0x4b, 0x46, 0x7f, 0xff, 0x0c, 0x10, 0}; // 上电为 85 度
+        eeprom_ = {0x4b, 0x46, 0x7f};
+        pad_[8] = Crc(pad_.data(), 8);
+    }
+
+    bool attached = true;
+    double temperature = 25.0; // 下一次转换的结果
+    double convertMs = 0;      // 转换时间 0 为按分辨率 (12 位 750ms)
+
+    void Edge(const Pin& pin, bool level, const uint8_t*, uint64_t t) override
+    {
+        if (!Same(pin, dq_) || !attached)
+            return;
+        if (!level)
+        { // 读时隙: 要发送的位在下降沿确定
+            fall_ = t;
+            slot_ = state_ == State::Send;
+            if (slot_)
+                slotBit_ = Bit(t);
+            return;
+        }
+        double low = Us(t - fall_);
+        if (low >= 480)
+        { // 复位 之后等待 ROM 命令
+            ++resets_;
+            presence_ = t + Cycles(30);
+            state_ = State::Rom;
+            bits_ = 0;
+            return;
+        }
+        if (state_ == State::Send)
+        {
+            if (++bits_ == 8)
+                NextSend();
+            return;
+        }
+        if (state_ == State::Idle)
+            return;
+        shift_ = static_cast<uint8_t>(shift_ >> 1 | (low < 30 ? 0x80 : 0));
+        if (++bits_ == 8)
+        {
+            bits_ = 0;
+            Receive(shift_, t);
+        }
+    }
+
+    uint8_t Drive(int port, const uint8_t*, uint64_t t) override
+    {
+        if (port != dq_.port || !attached)
+            return 0xff;
+        bool low = t >= presence_ && t < presence_ + Cycles(120);
+        if (slot_ && !slotBit_ && t - fall_ < Cycles(30))
+            low = true;
+        return low ? static_cast<uint8_t>(~dq_.Mask()) : 0xff;
+    }
+
+    void Report() const override
+    {
+        std::printf("  DS18B20  %llu resets  %llu conversions  %llu scratchpad reads\n",
+                    static_cast<unsigned long long>(resets_), static_cast<unsigned long long>(conversions_),
+                    static_cast<unsigned long long>(reads_));
+    }
+
+private:
+    enum class State
+    {
+        Idle,
+        Rom,
+        Function,
+        Write, // 写暂存器 TH TL 配置
+        Send,
+    };
+
+    static uint8_t Crc(const uint8_t* p, int n)
+    {
+        uint8_t crc = 0;
+        while (n--)
+        {
+            uint8_t b = *p++;
+            for (int i = 0; i < 8; ++i)
+            {
+                crc = ((crc ^ b) & 1) ? (crc >> 1) ^ 0x8c : crc >> 1;
+                b >>= 1;
+            }
+        }
+        return crc;
+    }
+
+    // 当前读时隙发送的位 转换中读为 0
+    bool Bit(uint64_t t) const
+    {
+        if (out_.empty())
+            return t >= convertDone_;
+        return (out_.front() >> bits_) & 1;
+    }
+
+    void NextSend()
+    {
+        bits_ = 0;
+        if (!out_.empty())
+            out_.erase(out_.begin());
+    }
+
+    void Finish(uint64_t t)
+    { // 转换完成时更新暂存器
+        if (!converting_ || t < convertDone_)
+            return;
+        converting_ = false;
+        int bits = 9 + ((pad_[4] >> 5) & 3);
+        int raw = static_cast<int>(std::lround(temperature * 16)) & ~((1 << (12 - bits)) - 1);
+        pad_[0] = raw & 0xff;
+        pad_[1] = (raw >> 8) & 0xff;
+        pad_[8] = Crc(pad_.data(), 8);
+    }
+
+    void Receive(uint8_t byte, uint64_t t)
+    {
+        Finish(t);
+        switch (state_)
+        {
+        case State::Rom:
+            if (byte == 0xcc)
+                state_ = State::Function;
+            else if (byte == 0x33)
+            { // 读 ROM: 家族码 28 序列号 CRC
+                std::vector<uint8_t> rom = {0x28, 0x51, 0x0e, 0x7a, 0x00, 0x00, 0x00};
+                rom.push_back(Crc(rom.data(), 7));
+                Send(rom);
+            }
+            else
+                state_ = State::Idle;
+            break;
+        case State::Function:
+            switch (byte)
+            {
+            case 0x44: {
+                double ms = convertMs > 0 ? convertMs : 93.75 * (1 << ((pad_[4] >> 5) & 3));
+                converting_ = true;
+                convertDone_ = t + Cycles(ms * 1000);
+                ++conversions_;
+                state_ = State::Send; // 读时隙返回是否完成
+                out_.clear();
+                break;
+            }
+            case 0xbe:
+                ++reads_;
+                Send(std::vector<uint8_t>(pad_.begin(), pad_.end()));
+                break;
+            case 0x4e:
+                state_ = State::Write;
+                written_ = 0;
+                break;
+            case 0x48:
+                std::copy(pad_.begin() + 2, pad_.begin() + 5, eeprom_.begin());
+                state_ = State::Idle;
+                break;
+            case 0xb8:
+                std::copy(eeprom_.begin(), eeprom_.end(), pad_.begin() + 2);
+                pad_[8] = Crc(pad_.data(), 8);
+                state_ = State::Idle;
+                break;
+            case 0xb4:
+                Send({0xff}); // 外部供电
+                break;
+            default:
+                state_ = State::Idle;
+            }
+            break;
+        case State::Write:
+            pad_[2 + written_] = written_ == 2 ? (byte & 0x60) | 0x1f : byte;
+            pad_[8] = Crc(pad_.data(), 8);
+            if (++written_ == 3)
+                state_ = State::Idle;
+            break;
+        default:
+            break;
+        }
+    }
+
+    void Send(const std::vector<uint8_t>& bytes)
+    {
+        out_ = bytes;
+        bits_ = 0;
+        state_ = State::Send;
+    }
+
+    Pin dq_;
+    State state_ = State::Idle;
+    std::array<uint8_t, 9> pad_{};
+    std::array<uint8_t, 3> eeprom_{};
+    std::vector<uint8_t> out_;
+    uint8_t shift_ = 0;
+    int bits_ = 0, written_ = 0;
+    bool converting_ = false, slot_ = false, slotBit_ = true;
+    uint64_t fall_ = 0, presence_ = ~0ull - Cycles(1000), convertDone_ = 0;
+    uint64_t resets_ = 0, conversions_ = 0, reads_ = 0;
+};
+
+// AT24C02: 器件地址 0xa0 256 字节 每页 8 字节 (页内地址回绕)
+// STOP 之后进入写周期 (默认 5ms) 期间不应答 读时地址在整个存储中回绕
+class At24c02 : public Device
+{
+public:
+    At24c02(Pin scl, Pin sda) : scl_(scl), sda_(sda) { mem.fill(0xff); }
+
+    std::array<uint8_t, 256> mem{};
+    double writeMs = 5;
+
+    void Edge(const Pin& pin, bool level, const uint8_t* latch, uint64_t t) override
+    {
+        bool sclHigh = High(latch, scl_), sda = High(latch, sda_);
+        if (Same(pin, sda_))
+        {
+            if (!sclHigh)
+                return;
+            if (!level)
+            { // START (重复 START 时放弃没有 STOP 的写入)
+                state_ = State::Addr;
+                pending_.clear();
+            }
+            else
+            { // STOP
+                if (state_ == State::Data && !pending_.empty())
+                {
+                    for (const auto& [a, v] : pending_)
+                        mem[a] = v;
+                    ++pages_;
+                    busyUntil_ = t + Cycles(writeMs * 1000);
+                }
+                pending_.clear();
+                state_ = State::Idle;
+            }
+            bits_ = 0;
+            low_ = false;
+            return;
+        }
+        if (!Same(pin, scl_) || state_ == State::Idle || state_ == State::Ignore)
+            return;
+        if (level)
+        { // 上升沿采样
+            if (bits_ < 8 && state_ != State::Read)
+                shift_ = static_cast<uint8_t>(shift_ << 1 | (sda ? 1 : 0));
+            else if (bits_ == 8 && state_ == State::Read)
+                masterAck_ = !sda;
+            ++bits_;
+            return;
+        }
+        // 下降沿改变 SDA
+        if (bits_ == 8)
+        {
+            low_ = false;
+            if (state_ != State::Read)
+                low_ = Accept(shift_, t);
+        }
+        else if (bits_ == 9)
+        {
+            bits_ = 0;
+            low_ = false;
+            if (state_ == State::ReadStart)
+            {
+                state_ = State::Read;
+                out_ = mem[addr_];
+                ++read_;
+            }
+            else if (state_ == State::Read)
+            {
+                if (!masterAck_)
+                {
+                    state_ = State::Ignore;
+                    return;
+                }
+                out_ = mem[++addr_];
+                ++read_;
+            }
+        }
+        if (state_ == State::Read && bits_ < 8)
+            low_ = !((out_ >> (7 - bits_)) & 1);
+    }
+
+    uint8_t Drive(int port, const uint8_t*, uint64_t) override
+    {
+        return port == sda_.port && low_ ? static_cast<uint8_t>(~sda_.Mask()) : 0xff;
+    }
+
+    void Report() const override
+    {
+        std::printf("  AT24C02  %llu page writes  %llu bytes read  %llu NACKs in write cycle\n",
+                    static_cast<unsigned long long>(pages_), static_cast<unsigned long long>(read_),
+                    static_cast<unsigned long long>(nacks_));
+    }
+
+private:
+    enum class State
+    {
+        Idle,
+        Addr,
+        Word,
+        Data,
+        ReadStart,
+        Read,
+        Ignore, // 不是本器件 或 读结束 等待 STOP
+    };
+
+    // 收到一个字节 返回是否应答
+    bool Accept(uint8_t byte, uint64_t t)
+    {
+        switch (state_)
+        {
+        case State::Addr:
+            if ((byte & 0xfe) != 0xa0)
+                break;
+            if (t < busyUntil_)
+            {
+                ++nacks_;
+                break;
+            }
+            state_ = (byte & 1) ? State::ReadStart : State::Word;
+            return true;
+        case State::Word:
+            addr_ = byte;
+            state_ = State::Data;
+            return true;
+        case State::Data:
+            pending_[addr_] = byte;
+            addr_ = (addr_ & 0xf8) | ((addr_ + 1) & 0x07);
+            return true;
+        default:
+            break;
+        }
+        state_ = State::Ignore;
+        return false;
+    }
+
+    Pin scl_, sda_;
+    State state_ = State::Idle;
+    std::map<uint8_t, uint8_t> pending_;
+    uint8_t shift_ = 0, addr_ = 0, out_ = 0;
+    int bits_ = 0;
+    bool low_ = false, masterAck_ = false;
+    uint64_t busyUntil_ = 0, pages_ = 0, read_ = 0, nacks_ = 0;
+};
+
+// 按键 (P3.4-P3.7 低电平有效) 与 INT0 按钮 (P3.2): 按下时拉低引脚
+class Buttons : public Device
+{
+public:
+    explicit Buttons(Pin keys) : keys_(keys) {}
+
+    void Press(int bit, uint64_t until) { until_[bit] = until; }
+
+    uint8_t Drive(int port, const uint8_t*, uint64_t t) override
+    {
+        if (port != keys_.port)
+            return 0xff;
+        uint8_t v = 0xff;
+        for (int bit = 0; bit < 8; ++bit)
+            if (t < until_[bit])
+                v &= ~(1 << bit);
+        return v;
+    }
+
+private:
+    Pin keys_;
+    uint64_t until_[8] = {};
+};
+
+// ------------------------------------------------------------------
+
+// 场景脚本 每行: 时间(ms) 命令 参数  # 之后为注释 按时间顺序执行
+//   temp 25.5          下一次转换的温度
+//   convert 200        DS18B20 转换时间 ms (0 按分辨率)
+//   sensor off|on      拔下/接上 DS18B20
+//   press P37 100      按下 P3.0-P3.7 或 INT0 (P3.2) 保持 ms
+//   uart 01 03 00 00   串口收到的字节 (十六进制)
+//   eeprom 00 35 ff    从地址 00 起写入 24c02 (十六进制 0 时刻即开机前的内容)
+//   eecheck 00 35      24c02 从地址 00 起应为这些字节 否则失败
+//   screen             打印 LCD 屏幕
+//   expect 1 Temp      LCD 第 1/2 行在 1s 内出现这段文字 否则失败
+class Script
+{
+public:
+    struct Action
+    {
+        uint64_t at;
+        int line;
+        std::string cmd;
+        double value = 0;
+        std::vector<uint8_t> bytes;
+        std::string text;
+    };
+
+    bool Load(const std::string& path, std::string& error)
+    {
+        std::ifstream in(path);
+        if (!in)
+        {
+            error = "cannot open " + path;
+            return false;
+        }
+        std::string line;
+        for (int n = 1; std::getline(in, line); ++n)
+        {
+            line = line.substr(0, line.find('#'));
+            std::istringstream ss(line);
+            double ms;
+            Action a;
+            if (!(ss >> ms))
+            {
+                if (line.find_first_not_of(" \t\r") == std::string::npos)
+                    continue;
+                error = path + ":" + std::to_string(n) + ": expected time in ms";
+                return false;
+            }
+            a.at = Cycles(ms * 1000);
+            a.line = n;
+            ss >> a.cmd;
+            bool ok = true;
+            std::string word;
+            if (a.cmd == "temp" || a.cmd == "convert")
+                ok = static_cast<bool>(ss >> a.value);
+            else if (a.cmd == "sensor")
+                ok = ss >> word && (word == "on" || word == "off"), a.value = word == "on";
+            else if (a.cmd == "press")
+            {
+                ok = ss >> word >> a.value && (word == "INT0" || (word.size() == 3 && word[0] == 'P' &&
+                                                                  word[1] == '3' && word[2] >= '0' && word[2] <= '7'));
+                a.bytes = {static_cast<uint8_t>(word == "INT0" ? 2 : word.back() - '0')};
+            }
+            else if (a.cmd == "uart" || a.cmd == "eeprom" || a.cmd == "eecheck")
+            {
+                unsigned v;
+                while (ss >> std::hex >> v)
+                    a.bytes.push_back(static_cast<uint8_t>(v));
+                ok = a.bytes.size() >= (a.cmd == "uart" ? 1u : 2u) && ss.eof() &&
+                     (a.cmd == "uart" || a.bytes[0] + a.bytes.size() <= 257);
+            }
+            else if (a.cmd == "expect")
+            {
+                ok = ss >> a.value && (a.value == 1 || a.value == 2);
+                std::getline(ss >> std::ws, a.text);
+                while (!a.text.empty() && (a.text.back() == ' ' || a.text.back() == '\r'))
+                    a.text.pop_back();
+            }
+            else
+                ok = a.cmd == "screen";
+            if (!ok)
+            {
+                error = path + ":" + std::to_string(n) + ": bad command '" + a.cmd + "'";
+                return false;
+            }
+            actions_.push_back(a);
+        }
+        std::stable_sort(actions_.begin(), actions_.end(),
+                         [](const Action& x, const Action& y) { return x.at < y.at; });
+        return true;
+    }
+
+    // 执行时刻 t 之前的动作
+    void Run(uint64_t t, i8051::Cpu& cpu, Ds18b20& sensor, Buttons& buttons, At24c02& eeprom,
+             const Hd44780& lcd)
+    {
+        for (; next_ < actions_.size() && actions_[next_].at <= t; ++next_)
+        {
+            const Action& a = actions_[next_];
+            if (a.cmd == "temp")
+                sensor.temperature = a.value;
+            else if (a.cmd == "convert")
+                sensor.convertMs = a.value;
+            else if (a.cmd == "sensor")
+                sensor.attached = a.value != 0;
+            else if (a.cmd == "press")
+                buttons.Press(a.bytes[0], t + Cycles(a.value * 1000));
+            else if (a.cmd == "uart")
+                for (uint8_t b : a.bytes)
+                    cpu.SerialRx(b);
+            else if (a.cmd == "screen")
+                lcd.Print(t);
+            else if (a.cmd == "eeprom")
+                std::copy(a.bytes.begin() + 1, a.bytes.end(), eeprom.mem.begin() + a.bytes[0]);
+            else if (a.cmd == "eecheck")
+                CheckEeprom(t, a, eeprom);
+            else
+                waiting_.push_back({t + Cycles(1e6), &a});
+        }
+        // 屏幕可能正在重画 每毫秒检查一次 1s 内没有出现为失败
+        if (!waiting_.empty() && t >= checked_ + Cycles(1000))
+            Check(t, lcd, false);
+    }
+
+    // 仿真结束时 还在等待的 expect 最后检查一次
+    void Finish(uint64_t t, const Hd44780& lcd) { Check(t, lcd, true); }
+
+    uint64_t failed = 0;
+
+private:
+    void CheckEeprom(uint64_t t, const Action& a, const At24c02& eeprom)
+    {
+        if (std::equal(a.bytes.begin() + 1, a.bytes.end(), eeprom.mem.begin() + a.bytes[0]))
+            return;
+        ++failed;
+        std::printf("[%9.3f s] line %d: eecheck %02X FAIL  24c02:", Us(t) / 1e6, a.line, a.bytes[0]);
+        for (size_t i = 1; i < a.bytes.size(); ++i)
+            std::printf(" %02X", eeprom.mem[a.bytes[0] + i - 1]);
+        std::printf("\n");
+    }
+
+    void Check(uint64_t t, const Hd44780& lcd, bool last)
+    {
+        checked_ = t;
+        for (auto it = waiting_.begin(); it != waiting_.end();)
+        {
+            const Action& a = *it->second;
+            if (lcd.Row(static_cast<int>(a.value) - 1).find(a.text) != std::string::npos)
+                it = waiting_.erase(it);
+            else if (last || t >= it->first)
+            {
+                ++failed;
+                std::printf("[%9.3f s] line %d: expect %d \"%s\" FAIL\n", Us(t) / 1e6, a.line,
+                            static_cast<int>(a.value), a.text.c_str());
+                lcd.Print(t);
+                it = waiting_.erase(it);
+            }
+            else
+                ++it;
+        }
+    }
+
+    std::vector<Action> actions_;
+    std::vector<std::pair<uint64_t, const Action*>> waiting_; // 等待中的 expect 与期限
+    size_t next_ = 0;
+    uint64_t checked_ = 0;
+};
+
+// ------------------------------------------------------------------
+
+class Vcd
+{
+public:
+    bool Open(const std::string& path, const Config& cfg)
+    {
+        out_.open(path);
+        if (!out_)
+            return false;
+        out_ << "$timescale 1ns $end\n$scope module board $end\n";
+        char id = '!';
+        for (int port = 0; port < 4; ++port)
+        {
+            ports_[port] = id++;
+            out_ << "$var wire 8 " << ports_[port] << " P" << port << " [7:0] $end\n";
+        }
+        for (const auto& [name, pin] : cfg.pins)
+        {
+            if (pin.bit < 0)
+                continue;
+            wires_.push_back({pin, id});
+            out_ << "$var wire 1 " << id++ << ' ' << name << " $end\n";
+        }
+        out_ << "$upscope $end\n$enddefinitions $end\n";
+        return true;
+    }
+
+    void Dump(const uint8_t* pins, const uint8_t* last, uint64_t t, bool all)
+    {
+        if (!out_.is_open())
+            return;
+        bool stamped = false;
+        for (int port = 0; port < 4; ++port)
+        {
+            if (!all && pins[port] == last[port])
+                continue;
+            if (!stamped)
+                out_ << '#' << static_cast<uint64_t>(std::llround(t * g_cycleNs)) << '\n';
+            stamped = true;
+            out_ << 'b';
+            for (int b = 7; b >= 0; --b)
+                out_ << ((pins[port] >> b) & 1);
+            out_ << ' ' << ports_[port] << '\n';
+            for (const auto& w : wires_)
+                if (w.pin.port == port && (all || ((pins[port] ^ last[port]) & w.pin.Mask())))
+                    out_ << ((pins[port] & w.pin.Mask()) ? '1' : '0') << w.id << '\n';
+        }
+    }
+
+private:
+    struct Wire
+    {
+        Pin pin;
+        char id;
+    };
+
+    std::ofstream out_;
+    char ports_[4] = {};
+    std::vector<Wire> wires_;
+};
+
+class Board : public i8051::Bus
+{
+public:
+    std::vector<Probe*> probes;
+    std::vector<Device*> devices;
+    Vcd vcd;
+    std::vector<uint8_t> uart;
+    i8051::Cpu* cpu = nullptr;
+
+    uint8_t Pins(int port, uint8_t latch) override
+    {
+        uint8_t v = latch;
+        for (Device* d : devices)
+            v &= d->Drive(port, latch_, stamp_);
+        return v;
+    }
+
+    void PortRead(int port, uint8_t mask) override
+    {
+        stamp_ = Now();
+        uint8_t pins = Pins(port, cpu->Latch(port));
+        for (Probe* p : probes)
+            p->Read(port, mask, pins, stamp_);
+    }
+
+    void SerialTx(uint8_t byte) override { uart.push_back(byte); }
+
+    // 每条指令之后: 找出锁存器与引脚的变化
+    void Settle()
+    {
+        uint64_t t = stamp_ = cpu->cycles;
+        for (int port = 0; port < 4; ++port)
+        {
+            uint8_t now = cpu->Latch(port), diff = now ^ latch_[port];
+            if (!diff)
+                continue;
+            latch_[port] = now;
+            for (Probe* p : probes)
+                p->Bus(port, now, t);
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                if (!(diff & (1 << bit)))
+                    continue;
+                for (Probe* p : probes)
+                    p->Edge({port, bit}, now & (1 << bit), t);
+                for (Device* d : devices)
+                    d->Edge({port, bit}, now & (1 << bit), latch_, t);
+            }
+        }
+        uint8_t pins[4];
+        for (int port = 0; port < 4; ++port)
+            pins[port] = Pins(port, latch_[port]);
+        vcd.Dump(pins, pins_, t, first_);
+        first_ = false;
+        std::copy(pins, pins + 4, pins_);
+    }
+
+private:
+    // 读引脚发生在指令执行中 按指令结束的时刻计
+    uint64_t Now() const { return cpu->cycles + i8051::Ops()[cpu->code[cpu->lastPc]].cycles; }
+
+    uint64_t stamp_ = 0; // 器件计算驱动电平的时刻
+    uint8_t latch_[4] = {0xff, 0xff, 0xff, 0xff};
+    uint8_t pins_[4] = {0xff, 0xff, 0xff, 0xff};
+    bool first_ = true;
+};
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    double seconds = 2, mhz = 11.0592;
+    int stackMin = -1;
+    bool reportOnly = false;
+    std::string hex, vcdPath, uartPath, configPath, scriptPath, eepromPath;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string a = argv[i];
+        bool more = i + 1 < argc;
+        if (a == "-t" && more)
+            seconds = std::atof(argv[++i]);
+        else if (a == "-c" && more)
+            mhz = std::atof(argv[++i]);
+        else if (a == "-v" && more)
+            vcdPath = argv[++i];
+        else if (a == "-u" && more)
+            uartPath = argv[++i];
+        else if (a == "-s" && more)
+            stackMin = std::atoi(argv[++i]);
+        else if (a == "-n")
+            reportOnly = true;
+        else if (a == "-p" && more)
+            configPath = argv[++i];
+        else if (a == "-k" && more)
+            scriptPath = argv[++i];
+        else if (a == "-e" && more)
+            eepromPath = argv[++i];
+        else if (hex.empty() && a[0] != '-')
+            hex = a;
+        else
+            hex.clear(), i = argc;
+    }
+    if (hex.empty() || seconds <= 0 || mhz <= 0)
+    {
+        std::cerr << "usage: sim51 [-t seconds] [-c crystal_mhz] [-v out.vcd] [-u uart.bin] [-s min_stack_free] [-n]"
+                     " [-p __config__.h] [-k script.txt] [-e eeprom.bin] firmware.hex\n";
+        return 2;
+    }
+    g_cycleNs = 12000.0 / mhz;
+
+    Config cfg;
+    if (!configPath.empty() && !cfg.Load(configPath))
+    {
+        std::cerr << "sim51: cannot open " << configPath << '\n';
+        return 1;
+    }
+
+    Board board;
+    i8051::Cpu cpu(board);
+    board.cpu = &cpu;
+    unsigned top;
+    if (!LoadHex(hex, cpu, top))
+    {
+        std::cerr << "sim51: cannot load " << hex << '\n';
+        return 1;
+    }
+    if (!vcdPath.empty() && !board.vcd.Open(vcdPath, cfg))
+    {
+        std::cerr << "sim51: cannot create " << vcdPath << '\n';
+        return 1;
+    }
+
+    OneWireCheck oneWire(cfg["DS18B20_DEFINE_DQ"]);
+    I2CCheck i2c(cfg["I2C_DEFINE_SCL"], cfg["I2C_DEFINE_SDA"]);
+    LcdCheck lcd(cfg["LCD1602_DEFINE_RS"], cfg["LCD1602_DEFINE_RW"], cfg["LCD1602_DEFINE_EN"], cfg["LCD1602_DATA"]);
+    Hd44780 screen(cfg["LCD1602_DEFINE_RS"], cfg["LCD1602_DEFINE_RW"], cfg["LCD1602_DEFINE_EN"],
+                   cfg["LCD1602_DATA"]);
+    Ds18b20 sensor(cfg["DS18B20_DEFINE_DQ"]);
+    At24c02 eeprom(cfg["I2C_DEFINE_SCL"], cfg["I2C_DEFINE_SDA"]);
+    Buttons buttons(cfg["KEYS"]);
+    board.probes = {&oneWire, &i2c, &lcd};
+    board.devices = {&screen, &sensor, &eeprom, &buttons};
+
+    if (!eepromPath.empty())
+    {
+        std::ifstream in(eepromPath, std::ios::binary);
+        if (!in)
+        {
+            std::cerr << "sim51: cannot open " << eepromPath << '\n';
+            return 1;
+        }
+        in.read(reinterpret_cast<char*>(eeprom.mem.data()), eeprom.mem.size());
+    }
+    Script script;
+    std::string error;
+    if (!scriptPath.empty() && !script.Load(scriptPath, error))
+    {
+        std::cerr << "sim51: " << error << '\n';
+        return 1;
+    }
+
+    uint64_t end = static_cast<uint64_t>(seconds * mhz * 1e6 / 12), steps = 0;
+    uint64_t irqs[6] = {};
+    bool lost = false;
+    board.Settle();
+    while (cpu.cycles < end)
+    {
+        script.Run(cpu.cycles, cpu, sensor, buttons, eeprom, screen);
+        cpu.Step();
+        ++steps;
+        if (cpu.vectored >= 0)
+            ++irqs[cpu.vectored];
+        board.Settle();
+        cpu.SampleInt0();
+        if (cpu.pc >= top)
+        {
+            lost = true;
+            break;
+        }
+    }
+
+    script.Finish(cpu.cycles, screen);
+    std::printf("sim51: %s  %.3f s (%llu cycles, %llu steps)  pc %04X\n", hex.c_str(), Us(cpu.cycles) / 1e6,
+                static_cast<unsigned long long>(cpu.cycles), static_cast<unsigned long long>(steps), cpu.pc);
+    if (lost)
+        std::printf("  pc left the program (%04X >= %04X) after %04X: %s\n", cpu.pc, top, cpu.lastPc,
+                    i8051::Disasm(cpu.code.data(), cpu.lastPc).c_str());
+    std::printf("interrupts: INT0 %llu  T0 %llu  T1 %llu  UART %llu  T2 %llu\n",
+                static_cast<unsigned long long>(irqs[0]), static_cast<unsigned long long>(irqs[1]),
+                static_cast<unsigned long long>(irqs[3]), static_cast<unsigned long long>(irqs[4]),
+                static_cast<unsigned long long>(irqs[5]));
+    // 中断的 CPU 占用 T2 只在发声时运行 另按 TR2 = 1 的时间计算一次
+    static const char* const isrName[6] = {"INT0", "T0", "INT1", "T1", "UART", "T2"};
+    bool tickLost = cpu.overruns[1] != 0;
+    std::printf("isr           count  avg cycles   max   cpu%%\n");
+    for (int i = 0; i < 6; ++i)
+    {
+        if (!irqs[i])
+            continue;
+        double avg = static_cast<double>(cpu.isrCycles[i]) / irqs[i];
+        std::printf("  %-5s %9llu  %8.1f  %5llu  %5.1f", isrName[i], static_cast<unsigned long long>(irqs[i]), avg,
+                    static_cast<unsigned long long>(cpu.isrMax[i]), 100.0 * cpu.isrCycles[i] / cpu.cycles);
+        if (i == 5 && cpu.t2Running)
+            std::printf("  (%.1f%% while TR2 = 1)", 100.0 * cpu.isrCycles[i] / cpu.t2Running);
+        if (i == 1 || i == 5)
+        {
+            std::printf("  %llu overflows lost", static_cast<unsigned long long>(cpu.overruns[i]));
+            if (cpu.overruns[i])
+                std::printf("%s (first at %.3f ms)", i == 1 && !reportOnly ? " FAIL" : "",
+                            Us(cpu.firstOverrun[i]) / 1e3);
+        }
+        std::printf("\n");
+    }
+    int stackFree = 0xff - cpu.spMax;
+    std::printf("stack: max SP %02X  free %d bytes", cpu.spMax, stackFree);
+    bool stackBad = stackMin >= 0 && stackFree < stackMin;
+    if (stackMin >= 0)
+        std::printf("  (need %d) %s", stackMin, stackBad ? "FAIL" : "ok");
+    std::printf("\n\n");
+
+    uint64_t violations = 0;
+    for (Probe* p : board.probes)
+    {
+        p->Report();
+        violations += p->Violations();
+    }
+    std::printf("\ndevices\n");
+    for (Device* d : board.devices)
+        d->Report();
+    std::printf("\nthroughput\n");
+    oneWire.Throughput();
+    i2c.Throughput();
+    lcd.Throughput();
+    if (!board.uart.empty())
+        std::printf("  UART     %8zu bytes\n", board.uart.size());
+
+    if (!uartPath.empty())
+    {
+        std::ofstream out(uartPath, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(board.uart.data()), static_cast<std::streamsize>(board.uart.size()));
+    }
+    std::printf("\n");
+    screen.Print(cpu.cycles);
+    std::printf("\n%llu timing violations", static_cast<unsigned long long>(violations));
+    if (!scriptPath.empty())
+        std::printf("  %llu failed expects", static_cast<unsigned long long>(script.failed));
+    if (reportOnly && (violations || tickLost))
+        std::printf("  (-n: timing violations and lost T0 ticks not counted)");
+    std::printf("\n");
+    if (reportOnly)
+        violations = 0, tickLost = false;
+    return violations || script.failed || stackBad || tickLost || lost ? 1 : 0;
+}
@@ -0,0 +1,251 @@
+/**
+ * thermsim.cpp
+ * ----------------------------------------------
+ * 主机端工具: 温度控制的闭环仿真 (没有实物机柜也能评估控制的改动)
+ * 直接编译固件中的 src/control.c (与 UpdateTemperature 使用同一份决策代码)
+ * 外面套一个机柜的热模型 加速仿真并统计控制性能
+ *
+ * 编译: g++ -std=c++17 -O2 -pthread -I../../include -o thermsim thermsim.cpp
+ * 用法: thermsim [-j 线程数] [-h 仿真小时数] [-o results.csv] [-n 每组上下限显示前几名]
+ *
+ * 热模型 (单节点):
+ *   C dT/dt = 负载 + 加热器 * 继电器 - (UA + 风扇 * 占空比) * (T - 环境温度)
+ *   DS18B20 有一阶滞后 (外壳与空气之间) 读数按分辨率截断
+ *   每次温度转换完成 (时间由分辨率决定) 调用一次 Control_Update
+ * 工况 (每段 仿真时长的一半):
+ *   热: 环境 25 度 负载按上限计算 在上限处平衡需要 70% 占空比 (风扇在比例区工作 步长和方式才有差别)
+ *       负载固定时 上限高的组合最低占空比就已经把温度压到上限以下 只剩开关动作
+ *   冷: 环境  0 度 负载 0W     继电器控制加热器把温度保持在下限附近 (与步长和方式无关)
+ * 统计:
+ *   超调     热工况超过上限的最大值 冷工况低于下限的最大值 (度)
+ *   稳定时间 每段工况中 第一次越界 到最后一次离开 [下限 - 0.5, 上限 + 0.5] (秒)
+ *   继电器   闭合次数
+ *   风扇能耗 风扇额定功率 * 占空比 的积分 (Wh)
+ * 扫描: 风扇档位步长 0-3 (只用于比例) 分辨率 0-3 控制方式 回差 上下限 多线程并行
+ *   上下限不同时超调和稳定时间没有可比性 所以每组上下限分别排名
+ */
+#define CTRL_STATE thread_local // 每个线程一份控制引擎状态
+#include "control.h"
+#include "../../src/control.c"
+#undef uint
+#undef uchar
+#undef bit
+#undef code
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// 与 global.c 中 cttcn 对应的温度转换时间 (秒)
+constexpr double CONVERT_TIME[4] = {0.09375, 0.1875, 0.375, 0.75};
+
+struct Plant
+{
+    double capacity = 5000.0;  // 热容 J/K (小机柜 空气与箱体)
+    double ua = 2.0;           // 箱体散热 W/K
+    double fanG = 40.0;        // 风扇全速时的换热 W/K
+    double fanPower = 3.0;     // 风扇额定功率 W
+    double heater = 100.0;     // 加热器功率 W
+    double hotDuty = 0.7;      // 热工况在上限处平衡需要的占空比
+    double sensorTau = 10.0;   // 传感器滞后 s
+    double dt = 0.01;          // 积分步长 s
+};
+
+struct Case
+{
+    int step;  // 风扇档位步长 (度)
+    int dsr;   // 分辨率 0-3
+    int mode;  // CTRL_PROP / CTRL_PI
+    int hyst;  // 上下限回差 (1/16 度)
+    int upper; // 上限
+    int lower; // 下限
+};
+
+struct Result
+{
+    Case c;
+    double overshootHot = 0;  // 度
+    double overshootCold = 0; // 度
+    double settleHot = 0;     // 秒
+    double settleCold = 0;    // 秒
+    int relayCycles = 0;
+    double fanWh = 0;
+    double score = 0;
+};
+
+// DS18B20 的读数: 单位 1/16 度 低位按分辨率截断
+int SensorRaw(double t, int dsr)
+{
+    int raw = static_cast<int>(std::floor(t * 16.0));
+    int mask = ~((1 << (3 - dsr)) - 1);
+    return raw & mask;
+}
+
+Result Run(const Case& c, const Plant& p, double hours)
+{
+    unsigned char defaults[CTRL_PARAM_NUM] = {0, 16, 16, 16, 4};
+    std::copy(defaults, defaults + CTRL_PARAM_NUM, ctrlParam);
+    ctrlParam[CTRL_MODE] = static_cast<unsigned char>(c.mode);
+    ctrlParam[CTRL_HYST_HIGH] = static_cast<unsigned char>(c.hyst);
+    ctrlParam[CTRL_HYST_LOW] = static_cast<unsigned char>(c.hyst);
+    Control_Reset();
+
+    Result r;
+    r.c = c;
+    const double total = hours * 3600.0, half = total / 2;
+    const double convert = CONVERT_TIME[c.dsr];
+    const double hotLoad = (p.ua + p.fanG * p.hotDuty) * (c.upper - 25.0);
+    double t = 20.0, sensor = 20.0, nextSample = convert;
+    double firstHot = -1, firstCold = -1; // 第一次越界的时刻
+    double lastOutHot = 0, lastOutCold = 0;
+    bool relay = false;
+    for (double now = 0; now < total; now += p.dt)
+    {
+        bool hot = now < half;
+        double ambient = hot ? 25.0 : 0.0;
+        double load = hot ? hotLoad : 0.0;
+        double duty = ctrlDuty / static_cast<double>(FAN_PWM_LEVELS);
+        double q = load + (relay ? p.heater : 0.0) -
+                   (p.ua + p.fanG * duty) * (t - ambient);
+        t += q / p.capacity * p.dt;
+        sensor += (t - sensor) / p.sensorTau * p.dt;
+        r.fanWh += p.fanPower * duty * p.dt / 3600.0;
+
+        if (now >= nextSample)
+        { // 温度转换完成 与 UpdateTemperature 相同的决策
+            nextSample += convert;
+            Control_Update(SensorRaw(sensor, c.dsr), static_cast<char>(c.upper),
+                           static_cast<char>(c.lower), static_cast<unsigned char>(c.step));
+            if (ctrl_below && !relay)
+                ++r.relayCycles;
+            relay = ctrl_below;
+        }
+
+        if (hot && firstHot < 0 && t > c.upper)
+            firstHot = now;
+        if (!hot && firstCold < 0 && t < c.lower)
+            firstCold = now;
+        if (t > c.upper + 0.5 || t < c.lower - 0.5)
+            (hot ? lastOutHot : lastOutCold) = now;
+        if (hot)
+            r.overshootHot = std::max(r.overshootHot, t - c.upper);
+        else
+            r.overshootCold = std::max(r.overshootCold, c.lower - t);
+    }
+    r.settleHot = firstHot < 0 ? 0 : std::max(0.0, lastOutHot - firstHot);
+    r.settleCold = firstCold < 0 ? 0 : std::max(0.0, lastOutCold - firstCold);
+    // 综合评分 (越小越好): 超调 稳定时间 继电器动作 风扇能耗 的加权和
+    r.score = r.overshootHot * 10 + r.overshootCold * 10 + (r.settleHot + r.settleCold) / 60 +
+              r.relayCycles * 0.5 + r.fanWh;
+    return r;
+}
+
+std::vector<Case> Sweep()
+{
+    std::vector<Case> cases;
+    const int limits[][2] = {{30, 10}, {35, 15}, {40, 5}};
+    for (auto& lim : limits)
+        for (int step = 0; step <= 3; ++step)
+            for (int dsr = 0; dsr <= 3; ++dsr)
+                for (int mode = CTRL_PROP; mode <= CTRL_PI; ++mode)
+                    for (int hyst : {0, 8, 16, 32})
+                        if (mode == CTRL_PROP || step == 0) // PI 不使用步长
+                            cases.push_back({step, dsr, mode, hyst, lim[0], lim[1]});
+    return cases;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    unsigned jobs = std::max(1u, std::thread::hardware_concurrency());
+    double hours = 4;
+    size_t top = 10;
+    std::string csvPath;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string a = argv[i];
+        if (a == "-j" && i + 1 < argc)
+            jobs = std::max(1, std::atoi(argv[++i]));
+        else if (a == "-h" && i + 1 < argc)
+            hours = std::atof(argv[++i]);
+        else if (a == "-n" && i + 1 < argc)
+            top = std::strtoul(argv[++i], nullptr, 10);
+        else if (a == "-o" && i + 1 < argc)
+            csvPath = argv[++i];
+        else
+        {
+            std::cerr << "usage: thermsim [-j threads] [-h hours] [-o results.csv] [-n top]\n";
+            return 2;
+        }
+    }
+    if (hours <= 0)
+    {
+        std::cerr << "thermsim: hours must be positive\n";
+        return 2;
+    }
+
+    const Plant plant;
+    std::vector<Case> cases = Sweep();
+    std::vector<Result> results(cases.size());
+    std::atomic<size_t> next{0};
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (unsigned j = 0; j < jobs; ++j)
+        pool.emplace_back([&] {
+            for (size_t i; (i = next++) < cases.size();)
+                results[i] = Run(cases[i], plant, hours);
+        });
+    for (auto& th : pool)
+        th.join();
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    if (!csvPath.empty())
+    {
+        std::ofstream out(csvPath);
+        out << "upper,lower,step,dsr,mode,hyst,overshoot_hot,overshoot_cold,"
+               "settle_hot_s,settle_cold_s,relay_cycles,fan_wh,score\n";
+        for (auto& r : results)
+            out << r.c.upper << ',' << r.c.lower << ',' << r.c.step << ',' << r.c.dsr << ','
+                << (r.c.mode == CTRL_PI ? "pi" : "prop") << ',' << r.c.hyst << ','
+                << r.overshootHot << ',' << r.overshootCold << ',' << r.settleHot << ','
+                << r.settleCold << ',' << r.relayCycles << ',' << r.fanWh << ',' << r.score
+                << '\n';
+    }
+
+    // 每组上下限内按评分排序
+    std::stable_sort(results.begin(), results.end(), [](const Result& a, const Result& b) {
+        if (a.c.upper != b.c.upper || a.c.lower != b.c.lower)
+            return a.c.upper != b.c.upper ? a.c.upper < b.c.upper : a.c.lower < b.c.lower;
+        return a.score < b.score;
+    });
+    std::printf("%zu runs x %.1f h simulated in %.2f s (%u threads, %.0fx real time)\n",
+                results.size(), hours, secs, jobs, results.size() * hours * 3600 / secs);
+    std::printf(" H/L  step dsr mode hyst | over+ over-  settle+ settle- relay fanWh | score\n");
+    for (size_t i = 0, rank = 0; i < results.size(); ++i)
+    {
+        const Result& r = results[i];
+        if (i && (r.c.upper != results[i - 1].c.upper || r.c.lower != results[i - 1].c.lower))
+        {
+            rank = 0;
+            std::printf("\n");
+        }
+        if (rank++ >= top)
+            continue;
+        std::printf("%2d/%-2d %4d %3d %4s %4.1f | %5.2f %5.2f %7.0f %7.0f %5d %5.1f | %5.1f\n",
+                    r.c.upper, r.c.lower, r.c.step, r.c.dsr, r.c.mode == CTRL_PI ? "pi" : "prop",
+                    r.c.hyst / 16.0, r.overshootHot, r.overshootCold, r.settleHot, r.settleCold,
+                    r.relayCycles, r.fanWh, r.score);
+    }
+    return 0;
+}
@@ -0,0 +1,304 @@
+/**
+ * trace2json.cpp
+ * ----------------------------------------------
+ * 主机端工具: 把串口遥测中的追踪帧 (固件定义 TRACE_ENABLE 见 trace.h)
+ * 转为 Chrome 的 Trace Event 格式 JSON 用 chrome://tracing 或 ui.perfetto.dev 打开
+ *
+ * 编译: g++ -std=c++17 -O2 -o trace2json trace2json.cpp
+ * 用法: trace2json [-c 晶振MHz] [capture.bin] > trace.json
+ *   capture.bin 为串口收到的原始字节 (没有时读标准输入) 例如
+ *   stty -F /dev/ttyUSB0 9600 raw && cat /dev/ttyUSB0 > capture.bin
+ *   其他类型的遥测帧忽略
+ *
+ * 帧 (COBS + CRC-8 与 collector 相同): TM_TRACE 序号 下标 总数 记录...
+ *   记录 4 字节: 节拍高 节拍低 事件 参数 从最早的一条开始
+ *   每次进入设置模式发送一次缓冲 (一个 dump) 每个 dump 显示为一个进程
+ * 时间:
+ *   节拍 1/3600 s 相邻两条记录的节拍差按 16 位回绕展开 (间隔小于约 18s)
+ *   中断进出的参数为 TL0 加上 TL0 个机器周期 (12 / 晶振)
+ *   T0 进入时节拍还没有加 1 (在 UpdateAboutTimer 中加) 所以算到下一个节拍
+ */
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 与固件 ultimate.h trace.h 保持一致
+constexpr uint8_t TM_TRACE = 0x03;
+constexpr double TICK_US = 1e6 / 3600;
+
+enum : uint8_t
+{
+    TR_T0_IN = 0x01,
+    TR_T0_OUT,
+    TR_T2_IN,
+    TR_T2_OUT,
+    TR_UART_IN,
+    TR_UART_OUT,
+    TR_X0_IN,
+    TR_X0_OUT,
+    TR_SENSOR_IN = 0x10,
+    TR_SENSOR_OUT,
+    TR_LCD_FLUSH,
+    TR_EE_CONFIG,
+    TR_EE_CHECKPOINT,
+    TR_MODE,
+    TR_RELAY,
+    TR_NOTE,
+    TR_NOTE_STALL,
+};
+
+struct Record
+{
+    uint16_t tick;
+    uint8_t id;
+    uint8_t arg;
+};
+
+uint8_t Crc8(const uint8_t* p, size_t n)
+{
+    uint8_t crc = 0;
+    while (n--)
+    {
+        uint8_t b = *p++;
+        for (int i = 0; i < 8; ++i)
+        {
+            crc = ((crc ^ b) & 1) ? (crc >> 1) ^ 0x8c : crc >> 1;
+            b >>= 1;
+        }
+    }
+    return crc;
+}
+
+// 原地解码 返回解码后的长度 格式错误返回 -1
+int CobsDecode(uint8_t* p, size_t n)
+{
+    size_t in = 0, out = 0;
+    while (in < n)
+    {
+        uint8_t dist = p[in++];
+        if (!dist || in + dist - 1 > n)
+            return -1;
+        for (uint8_t i = 1; i < dist; ++i)
+            p[out++] = p[in++];
+        if (dist != 0xff && in < n)
+            p[out++] = 0;
+    }
+    return static_cast<int>(out);
+}
+
+class Writer
+{
+public:
+    explicit Writer(double mhz) : cycleUs_(12.0 / mhz) {}
+
+    // 一个完整的 dump (记录从最早开始)
+    void Dump(const std::vector<Record>& recs)
+    {
+        ++pid_;
+        tids_.clear(); // 线程名称按进程记录
+        Meta("process_name", 0, "dump " + std::to_string(pid_));
+        uint64_t ticks = 0;
+        for (size_t i = 0; i < recs.size(); ++i)
+        {
+            if (i)
+                ticks += static_cast<uint16_t>(recs[i].tick - recs[i - 1].tick);
+            Emit(recs[i], ticks);
+        }
+    }
+
+    void Finish() { std::cout << "\n],\"displayTimeUnit\":\"ms\"}\n"; }
+
+private:
+    void Begin(char ph, double ts, int tid)
+    {
+        std::cout << (first_ ? "{\"traceEvents\":[\n" : ",\n");
+        first_ = false;
+        std::printf("{\"ph\":\"%c\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f", ph, pid_, tid, ts);
+    }
+
+    void Meta(const char* what, int tid, const std::string& name)
+    {
+        Begin('M', 0, tid);
+        std::printf(",\"name\":\"%s\",\"args\":{\"name\":\"%s\"}}", what, name.c_str());
+    }
+
+    int Thread(const std::string& name)
+    {
+        auto it = tids_.find(name);
+        if (it != tids_.end())
+            return it->second;
+        int tid = static_cast<int>(tids_.size()) + 1;
+        tids_[name] = tid;
+        Meta("thread_name", tid, name);
+        return tid;
+    }
+
+    void Slice(char ph, double ts, const std::string& thread, const char* name)
+    {
+        Begin(ph, ts, Thread(thread));
+        std::printf(",\"name\":\"%s\"}", name);
+    }
+
+    void Instant(double ts, const std::string& thread, const char* name, int arg)
+    {
+        Begin('i', ts, Thread(thread));
+        std::printf(",\"s\":\"t\",\"name\":\"%s\",\"args\":{\"arg\":%d}}", name, arg);
+    }
+
+    void Counter(double ts, const char* name, int value)
+    {
+        Begin('C', ts, 0);
+        std::printf(",\"name\":\"%s\",\"args\":{\"value\":%d}}", name, value);
+    }
+
+    void Emit(const Record& r, uint64_t ticks)
+    {
+        static const char* const isr[] = {"T0", "T2", "UART", "X0"};
+        double ts = ticks * TICK_US;
+        if (r.id >= TR_T0_IN && r.id <= TR_X0_OUT)
+        {
+            int src = (r.id - TR_T0_IN) / 2;
+            bool in = !((r.id - TR_T0_IN) & 1);
+            if (r.id == TR_T0_IN)
+                ts += TICK_US;
+            Slice(in ? 'B' : 'E', ts + r.arg * cycleUs_, isr[src], isr[src]);
+            return;
+        }
+        switch (r.id)
+        {
+        case TR_SENSOR_IN:
+            Slice('B', ts, "main", "DS18B20 read");
+            break;
+        case TR_SENSOR_OUT:
+            Slice('E', ts, "main", "DS18B20 read");
+            Counter(ts, "temperature", static_cast<int8_t>(r.arg));
+            break;
+        case TR_LCD_FLUSH:
+            Instant(ts, "main", "LCD flush", r.arg);
+            break;
+        case TR_EE_CONFIG:
+            Instant(ts, "main", "EEPROM config", r.arg);
+            break;
+        case TR_EE_CHECKPOINT:
+            Instant(ts, "main", "EEPROM checkpoint", r.arg);
+            break;
+        case TR_MODE:
+            Instant(ts, "X0", r.arg ? "settings mode" : "view mode", r.arg);
+            Counter(ts, "settings", r.arg);
+            break;
+        case TR_RELAY:
+            Instant(ts, "main", r.arg ? "relay on" : "relay off", r.arg);
+            Counter(ts, "relay", r.arg);
+            break;
+        case TR_NOTE:
+            Counter(ts, "note", r.arg);
+            break;
+        case TR_NOTE_STALL:
+            Instant(ts, "T0", "note stall", r.arg);
+            break;
+        default: {
+            char name[16];
+            std::snprintf(name, sizeof(name), "id 0x%02x", r.id);
+            Instant(ts, "main", name, r.arg);
+        }
+        }
+    }
+
+    double cycleUs_;
+    int pid_ = 0;
+    bool first_ = true;
+    std::map<std::string, int> tids_;
+};
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    double mhz = 11.0592;
+    std::string path;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string a = argv[i];
+        if (a == "-c" && i + 1 < argc)
+            mhz = std::atof(argv[++i]);
+        else if (path.empty() && a[0] != '-')
+            path = a;
+        else
+        {
+            std::cerr << "usage: trace2json [-c crystal_mhz] [capture.bin] > trace.json\n";
+            return 2;
+        }
+    }
+    if (mhz <= 0)
+    {
+        std::cerr << "trace2json: crystal must be positive\n";
+        return 2;
+    }
+
+    std::vector<uint8_t> data;
+    if (path.empty())
+        data.assign(std::istreambuf_iterator<char>(std::cin), {});
+    else
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in)
+        {
+            std::cerr << "trace2json: cannot open " << path << '\n';
+            return 1;
+        }
+        data.assign(std::istreambuf_iterator<char>(in), {});
+    }
+
+    Writer out(mhz);
+    std::vector<Record> dump;
+    size_t expect = 0, dumps = 0, bad = 0, incomplete = 0;
+    size_t start = 0;
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        if (data[i])
+            continue;
+        uint8_t* f = data.data() + start;
+        size_t len = i - start;
+        start = i + 1;
+        int n = len ? CobsDecode(f, len) : -1;
+        if (n < 2 || Crc8(f, n - 1) != f[n - 1])
+        {
+            bad += len != 0;
+            continue;
+        }
+        --n;
+        if (f[0] != TM_TRACE || n < 4 || (n - 4) % 4)
+            continue;
+        size_t index = f[2], total = f[3];
+        if (index == 0 || index != dump.size() || total != expect)
+        { // 新的 dump (上一个没有收完则丢弃)
+            incomplete += !dump.empty();
+            dump.clear();
+            expect = total;
+            if (index != 0)
+                continue;
+        }
+        for (int j = 4; j < n; j += 4)
+            dump.push_back({static_cast<uint16_t>(f[j] << 8 | f[j + 1]), f[j + 2], f[j + 3]});
+        if (dump.size() >= expect)
+        {
+            out.Dump(dump);
+            ++dumps;
+            dump.clear();
+        }
+    }
+    incomplete += !dump.empty();
+    if (!dumps)
+        std::cout << "{\"traceEvents\":[";
+    out.Finish();
+    std::fprintf(stderr, "%zu dumps, %zu incomplete, %zu bad frames\n", dumps, incomplete, bad);
+    return 0;
+}
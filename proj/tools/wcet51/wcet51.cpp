@@ -0,0 +1,1039 @@
+/**
+ * wcet51.cpp
+ * ----------------------------------------------
+ * 主机端工具: 静态分析 Keil 生成的 HEX 每个函数与每个中断的最坏执行时间 (WCET)
+ * 取代注释中手算的周期数 (如 DS18B20 中 "约 3210 (3211) 3663") 也覆盖仿真没有走到的路径
+ *
+ * 编译: g++ -std=c++17 -O2 -o wcet51 wcet51.cpp
+ * 用法: wcet51 [-c 晶振MHz] [-b bounds.txt] [-p 上次的报告] Ultimate.m51 Ultimate.hex > wcet.txt
+ *   Listings 中的 .lst 没有汇编 所以用 HEX 反汇编 (指令表与 sim51 共用 i8051.h)
+ *   .m51 提供函数入口 (PUBLIC PROC) 与源代码行号 (LINE#) 报告中的循环按 模块:行 标出
+ *   -p 在报告最后列出与上次报告相比改变的函数
+ *
+ * 分析:
+ *   从每个函数入口沿控制流找出所有指令 调用 (ACALL LCALL) 加上被调函数的 WCET
+ *   跳到另一个函数入口视为尾调用 JMP @A+DPTR 前面是 MOV DPTR,#表 时 表中的 AJMP/LJMP/SJMP 都是后继
+ *   循环为控制流图的强连通分量 由内向外把循环收缩为一个节点:
+ *     循环的周期 = (上限 - 1) * 一次迭代的最长路径 + 从循环头到出口的最长路径
+ *     从中间进入的循环 (Keil 的 do-while) 另加从进入处走一次的最长路径
+ *   最后在无环图上求最长路径 条件跳转两个方向的周期相同 不需要区分
+ * 循环上限 (循环头最多执行的次数):
+ *   DJNZ 计数且进入循环前 MOV 计数器,#n 的自动得到 n (0 为 256)
+ *   计数器为参数 (R0-R7) 而调用处 MOV Rn,#n 为常数的 被调函数按这个常数单独分析 如 DS18B20_Delay10us(60)
+ *   其他的写在 bounds.txt 中 (格式见该文件) 没有上限的循环按执行一次计 结果后面加 "+" 并列在报告最后
+ * 栈: 调用 2 字节 PUSH 1 字节 中断另加硬件压入的 2 字节
+ */
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "../sim51/i8051.h"
+
+namespace {
+
+using i8051::Flow;
+using i8051::Ops;
+
+struct Segment
+{
+    unsigned base, length;
+    std::string name;
+};
+
+// .m51 中的符号 段 行号
+struct MapFile
+{
+    std::vector<Segment> code;
+    std::map<unsigned, std::string> entries; // 函数入口
+    std::map<unsigned, std::string> lines;   // 地址 -> "模块:行"
+    std::set<unsigned> vectors;
+
+    bool Load(const std::string& path)
+    {
+        std::ifstream in(path);
+        if (!in)
+            return false;
+        static const std::regex seg(R"(^\s+CODE\s+([0-9A-F]+)H\s+([0-9A-F]+)H\s+(\w+)(?:\s+(\S+))?\s*$)");
+        static const std::regex sym(R"(^\s+C:([0-9A-F]+)H\s+(PUBLIC|SYMBOL|LINE#)\s+(\S+)\s*$)");
+        static const std::regex proc(R"(^\s+-------\s+(MODULE|PROC|ENDPROC|ENDMOD)\s+(\S+)\s*$)");
+        std::map<unsigned, std::string> publics, labels;
+        std::string line, module, procName;
+        bool procStart = false;
+        std::smatch m;
+        while (std::getline(in, line))
+        {
+            if (std::regex_match(line, m, seg))
+            {
+                code.push_back({Hex(m[1]), Hex(m[2]), m[4]});
+                unsigned base = Hex(m[1]);
+                if (m[3] == "ABSOLUTE" && base % 8 == 3 && base < 0x30)
+                    vectors.insert(base); // 中断向量处的 LJMP
+            }
+            else if (std::regex_match(line, m, proc))
+            {
+                if (m[1] == "MODULE")
+                    module = m[2];
+                procStart = m[1] == "PROC";
+                procName = m[2];
+            }
+            else if (std::regex_match(line, m, sym))
+            {
+                unsigned addr = Hex(m[1]);
+                if (m[2] == "PUBLIC")
+                    publics[addr] = m[3];
+                else if (m[2] == "SYMBOL")
+                {
+                    if (m[3].str().compare(0, 2, "L?") == 0)
+                        labels[addr] = m[3]; // 编译器合并的公共代码 (用 LCALL 调用)
+                }
+                else
+                {
+                    lines[addr] = module + ":" + m[3].str();
+                    if (procStart && !entries.count(addr))
+                        entries[addr] = procName; // static 函数只有 PROC
+                    procStart = false;
+                }
+            }
+        }
+        // PUBLIC 的名字带大小写 常量表 (?CO?) 不是函数
+        for (const auto& [addr, name] : publics)
+        {
+            const Segment* s = SegmentOf(addr);
+            if (s && s->name.compare(0, 4, "?CO?") != 0 && s->name != "?C_INITSEG")
+                entries[addr] = name;
+        }
+        for (const auto& [addr, name] : labels)
+            if (!entries.count(addr))
+                entries[addr] = name;
+        return true;
+    }
+
+    const Segment* SegmentOf(unsigned addr) const
+    {
+        for (const Segment& s : code)
+            if (addr >= s.base && addr < s.base + s.length)
+                return &s;
+        return nullptr;
+    }
+
+    // 地址所在的源代码行 (与地址在同一个段中) 没有时为 符号+偏移
+    std::string Where(unsigned addr) const
+    {
+        const Segment* s = SegmentOf(addr);
+        auto it = lines.upper_bound(addr);
+        if (it != lines.begin() && s && (--it)->first >= s->base)
+            return it->second;
+        auto e = entries.upper_bound(addr);
+        if (e == entries.begin())
+            return Addr(addr);
+        --e;
+        char buf[16];
+        std::snprintf(buf, sizeof(buf), "+0x%x", addr - e->first);
+        return e->second + buf;
+    }
+
+    static unsigned Hex(const std::string& s) { return static_cast<unsigned>(std::stoul(s, nullptr, 16)); }
+
+    static std::string Addr(unsigned addr)
+    {
+        char buf[16];
+        std::snprintf(buf, sizeof(buf), "%04X", addr);
+        return buf;
+    }
+};
+
+bool LoadHex(const std::string& path, std::vector<uint8_t>& code, unsigned& top)
+{
+    std::ifstream in(path);
+    if (!in)
+        return false;
+    std::string line;
+    top = 0;
+    while (std::getline(in, line))
+    {
+        if (line.size() < 11 || line[0] != ':')
+            continue;
+        auto byte = [&line](size_t i) { return static_cast<unsigned>(std::stoul(line.substr(1 + i * 2, 2), nullptr, 16)); };
+        unsigned n = byte(0), addr = byte(1) << 8 | byte(2);
+        if (byte(3) == 1)
+            break;
+        if (byte(3) != 0)
+            continue;
+        for (unsigned i = 0; i < n && addr + i < code.size(); ++i)
+            code[addr + i] = static_cast<uint8_t>(byte(4 + i));
+        top = std::max(top, addr + n);
+    }
+    return true;
+}
+
+// bounds.txt 中的一条: 上限 或 由参数寄存器算出的上限 (调用处为常数时)
+struct Fact
+{
+    long max;
+    int hi = -1, lo = -1; // 参数寄存器 R6R7 为 hi 6 lo 7 只用一个时 hi 为 -1
+    long offset = 0;
+};
+
+using Args = std::map<int, unsigned>; // 调用处为常数的 R0-R7
+
+struct LoopInfo
+{
+    std::string where, func, how;
+    long bound; // -1 没有上限
+    uint64_t iter;
+};
+
+struct Func
+{
+    std::string name;
+    int state = 0; // 0 未分析 1 分析中 2 完成
+    uint64_t wcet = 0;
+    bool open = false; // 含没有上限的循环 递归 或无法分析的跳转
+    int stack = 0;
+    std::set<int> params; // 循环上限取决于的参数寄存器
+    std::vector<std::string> notes;
+};
+
+class Analyzer
+{
+public:
+    Analyzer(const std::vector<uint8_t>& code, unsigned top, const MapFile& map,
+             const std::map<std::string, Fact>& bounds)
+        : code_(code), top_(top), map_(map), bounds_(bounds)
+    {
+        for (const auto& [key, n] : bounds)
+            if (key.find('@') != std::string::npos)
+                callers_.insert(key.substr(key.find('@') + 1));
+    }
+
+    // 键为 (入口, 上下文) 以下两种情况被调函数单独分析 其余的上下文为 ""
+    //   bounds.txt 中有 键@调用者 (调用者为调用指令所在的函数 不是经公共代码进入的函数)
+    //   循环上限取决于参数 而调用处参数为常数 (如 MOV R7,#3CH  LCALL _DS18B20_Delay10us)
+    std::map<std::pair<unsigned, std::string>, Func> funcs;
+    std::vector<LoopInfo> loops;
+    std::set<std::string> usedBounds;
+
+    std::string Name(unsigned addr) const
+    {
+        auto it = map_.entries.find(addr);
+        return it != map_.entries.end() ? it->second : "sub_" + MapFile::Addr(addr);
+    }
+
+    const Func& Analyze(unsigned entry, const std::string& caller = "", const Args& args = {})
+    {
+        std::string ctx = callers_.count(caller) ? caller : "";
+        std::string key = ctx;
+        Args used;
+        if (!args.empty())
+        {
+            const Func& base = Analyze(entry, caller);
+            for (const auto& [r, v] : args)
+                if (base.params.count(r))
+                    used[r] = v;
+            if (used.empty() || base.state != 2)
+                return base;
+            key += Describe(used);
+        }
+        Func& f = funcs[{entry, key}];
+        if (f.state == 2)
+            return f;
+        if (f.state == 1)
+        { // 递归: 调用者标记为没有上限
+            recursion_ = true;
+            return f;
+        }
+        f.state = 1;
+        f.name = Name(entry);
+        bool recursion = recursion_;
+        recursion_ = false;
+        Graph g;
+        Explore(entry, f, g);
+        std::string outer = ctx_;
+        Args outerArgs = args_;
+        Func* outerFunc = cur_;
+        unsigned outerEntry = entry_;
+        ctx_ = ctx;
+        args_ = used;
+        cur_ = &f;
+        entry_ = entry;
+        if (recursion_)
+        {
+            f.open = true;
+            f.notes.push_back("recursive call");
+        }
+        recursion_ = recursion;
+        Stack(entry, f, g);
+        Collapse(entry, f, g);
+        ctx_ = outer;
+        args_ = outerArgs;
+        cur_ = outerFunc;
+        entry_ = outerEntry;
+        std::sort(f.notes.begin(), f.notes.end());
+        f.notes.erase(std::unique(f.notes.begin(), f.notes.end()), f.notes.end());
+        f.state = 2;
+        return f;
+    }
+
+private:
+    struct Graph
+    {
+        std::map<unsigned, std::set<unsigned>> succ;
+        std::map<unsigned, uint64_t> weight;
+        std::map<unsigned, int> push;  // 栈的变化 (PUSH POP)
+        std::map<unsigned, int> extra; // 调用时需要的栈
+        std::vector<std::pair<unsigned, bool>> calls; // 调用 (true 为尾调用)
+    };
+
+    static std::string Describe(const Args& args)
+    {
+        std::string s;
+        for (const auto& [r, v] : args)
+            s += (s.empty() ? "(R" : ",R") + std::to_string(r) + "=" + std::to_string(v);
+        return s + ")";
+    }
+
+    uint8_t At(unsigned a) const { return code_[a & 0xffff]; }
+
+    int Target(unsigned pc) const { return i8051::Target(code_.data(), static_cast<uint16_t>(pc)); }
+
+    // 找出函数的所有指令与边
+    void Explore(unsigned entry, Func& f, Graph& g)
+    {
+        std::vector<unsigned> work = {entry};
+        while (!work.empty())
+        {
+            unsigned pc = work.back();
+            work.pop_back();
+            if (g.succ.count(pc))
+                continue;
+            auto& succ = g.succ[pc];
+            if (pc >= top_)
+            {
+                g.weight[pc] = 0;
+                f.open = true;
+                f.notes.push_back("runs past the end of code at " + MapFile::Addr(pc));
+                continue;
+            }
+            uint8_t op = At(pc);
+            const i8051::OpInfo& info = Ops()[op];
+            unsigned next = pc + info.bytes;
+            uint64_t w = info.cycles;
+            int target = Target(pc);
+            switch (info.flow)
+            {
+            case Flow::Seq:
+                succ.insert(next);
+                break;
+            case Flow::Branch:
+                succ.insert(next);
+                succ.insert(static_cast<unsigned>(target));
+                break;
+            case Flow::Jump:
+                if (static_cast<unsigned>(target) != entry && map_.entries.count(target))
+                    g.calls.push_back({pc, true}); // 尾调用
+                else
+                    succ.insert(static_cast<unsigned>(target));
+                break;
+            case Flow::Call:
+                g.calls.push_back({pc, false});
+                succ.insert(next);
+                break;
+            case Flow::Ret:
+            case Flow::Reti:
+                break;
+            case Flow::Indirect:
+                if (!JumpTable(pc, succ))
+                {
+                    f.open = true;
+                    f.notes.push_back("indirect jump at " + map_.Where(pc));
+                }
+                break;
+            }
+            if (op == 0xc0)
+                g.push[pc] = 1;
+            else if (op == 0xd0)
+                g.push[pc] = -1;
+            g.weight[pc] = w;
+            for (unsigned s : succ)
+                work.push_back(s);
+        }
+
+        // 所有指令找到后才能知道调用处哪些参数为常数
+        std::map<unsigned, std::set<unsigned>> preds;
+        for (const auto& [u, ss] : g.succ)
+            for (unsigned v : ss)
+                preds[v].insert(u);
+        for (const auto& [pc, tail] : g.calls)
+        {
+            const Func& callee = Analyze(Target(pc), Owner(pc), Constants(pc, preds));
+            g.weight[pc] += callee.wcet;
+            f.open |= callee.open;
+            g.extra[pc] = (tail ? 0 : 2) + callee.stack;
+        }
+    }
+
+    // 调用前 (沿唯一前驱) MOV Rn,#立即数 给出的参数
+    Args Constants(unsigned pc, const std::map<unsigned, std::set<unsigned>>& preds) const
+    {
+        Args args;
+        std::set<int> seen;
+        for (int n = 0; n < 8; ++n)
+        {
+            auto it = preds.find(pc);
+            if (it == preds.end() || it->second.size() != 1)
+                break;
+            pc = *it->second.begin();
+            uint8_t p[3] = {At(pc), At(pc + 1), At(pc + 2)};
+            if (Ops()[p[0]].flow == Flow::Call)
+                break; // 被调函数可能改写寄存器
+            if ((p[0] & 0xf8) == 0x78 && !seen.count(p[0] & 7))
+                args[p[0] & 7] = p[1];
+            for (int w : Writes(p))
+                seen.insert(w);
+        }
+        return args;
+    }
+
+    // MOV DPTR,#表  ...  JMP @A+DPTR  表为连续的 AJMP/LJMP/SJMP
+    bool JumpTable(unsigned pc, std::set<unsigned>& succ) const
+    {
+        for (unsigned back = 1; back <= 12 && back <= pc; ++back)
+        {
+            unsigned p = pc - back;
+            if (At(p) != 0x90 || p + 3 > pc)
+                continue;
+            unsigned table = At(p + 1) << 8 | At(p + 2);
+            uint8_t first = At(table);
+            int size = (first & 0x1f) == 0x01 ? 2 : first == 0x02 ? 3 : first == 0x80 ? 2 : 0;
+            if (!size)
+                return false;
+            for (unsigned a = table; a < top_ && succ.size() < 128; a += size)
+            {
+                uint8_t op = At(a);
+                bool same = size == 3 ? op == 0x02 : (op & 0x1f) == 0x01 || op == 0x80;
+                if (!same)
+                    break;
+                succ.insert(a);
+            }
+            return !succ.empty();
+        }
+        return false;
+    }
+
+    // 最大栈深度 (每条指令取第一次到达时的深度)
+    void Stack(unsigned entry, Func& f, const Graph& g)
+    {
+        std::map<unsigned, int> depth;
+        std::vector<std::pair<unsigned, int>> work = {{entry, 0}};
+        int most = 0;
+        while (!work.empty())
+        {
+            auto [pc, d] = work.back();
+            work.pop_back();
+            if (depth.count(pc))
+                continue;
+            depth[pc] = d;
+            auto e = g.extra.find(pc);
+            most = std::max(most, d + (e != g.extra.end() ? e->second : 0));
+            auto p = g.push.find(pc);
+            int nd = d + (p != g.push.end() ? p->second : 0);
+            most = std::max(most, nd);
+            for (unsigned s : g.succ.at(pc))
+                work.push_back({s, nd});
+        }
+        f.stack = most;
+    }
+
+    // 写入的 寄存器 (0-7) 或直接地址 (0x100 + addr) 用于检查循环计数器
+    static std::vector<int> Writes(const uint8_t* p)
+    {
+        uint8_t op = p[0], lo = op & 0x0f, hi = op >> 4;
+        if (lo >= 8 && (hi == 0x0 || hi == 0x1 || hi == 0x7 || hi == 0xa || hi == 0xc || hi == 0xd || hi == 0xf))
+            return {op & 7};
+        switch (op)
+        {
+        case 0x05:
+        case 0x15:
+        case 0x42:
+        case 0x43:
+        case 0x52:
+        case 0x53:
+        case 0x62:
+        case 0x63:
+        case 0x75:
+        case 0x86:
+        case 0x87:
+        case 0xc5:
+        case 0xd0:
+        case 0xd5:
+        case 0xf5:
+            return {0x100 + p[1]};
+        case 0x85:
+            return {0x100 + p[2]};
+        default:
+            if (op >= 0x88 && op <= 0x8f)
+                return {0x100 + p[1]};
+            return {};
+        }
+    }
+
+    // DJNZ 计数的循环: 进入循环前 MOV 计数器,#n (中间可以有 DEC INC) 或计数器为调用处是常数的参数
+    long AutoBound(unsigned head, const std::set<unsigned>& body, const std::vector<unsigned>& latches,
+                   const std::map<unsigned, std::set<unsigned>>& preds, std::string& how)
+    {
+        // 每条跳回的指令都是 DJNZ 同一个计数器
+        int counter = -1;
+        for (unsigned latch : latches)
+        {
+            uint8_t op = At(latch);
+            int c = op >= 0xd8 ? op & 7 : op == 0xd5 ? 0x100 + At(latch + 1) : -1;
+            if (c < 0 || (counter >= 0 && c != counter) || static_cast<unsigned>(Target(latch)) != head)
+                return -1;
+            counter = c;
+        }
+        if (counter < 0)
+            return -1;
+        for (unsigned pc : body)
+        {
+            uint8_t p[3] = {At(pc), At(pc + 1), At(pc + 2)};
+            if (std::find(latches.begin(), latches.end(), pc) != latches.end())
+                continue;
+            for (int w : Writes(p))
+                if (w == counter)
+                    return -1;
+        }
+        // 进入循环头的 (循环外的) 前驱只有一条 沿唯一前驱向前找
+        std::vector<unsigned> outside;
+        for (unsigned p : preds.at(head))
+            if (!body.count(p))
+                outside.push_back(p);
+        if (outside.size() != 1)
+            return -1;
+        unsigned pc = outside[0], from = head;
+        long adjust = 0;
+        bool guarded = false; // MOV A,Rn  JZ 跳过循环: 计数为 0 时不进入
+        auto count = [&](long init) {
+            long n = (init + adjust) & 0xff;
+            return n ? n : guarded ? 1 : 256;
+        };
+        for (int n = 0; n < 16; ++n)
+        {
+            uint8_t p[3] = {At(pc), At(pc + 1), At(pc + 2)};
+            bool init = counter < 0x100 ? p[0] == (0x78 | counter) : p[0] == 0x75 && p[1] == counter - 0x100;
+            if (init)
+            {
+                how = "DJNZ";
+                return count(counter < 0x100 ? p[1] : p[2]);
+            }
+            if (Ops()[p[0]].flow == Flow::Call)
+                return -1;
+            if (counter < 8 && pc && At(pc - 1) == (0xe8 | counter) && !adjust &&
+                ((p[0] == 0x60 && from == pc + 2) || (p[0] == 0x70 && from == static_cast<unsigned>(Target(pc)))))
+                guarded = true;
+            bool dir = counter >= 0x100 && p[1] == counter - 0x100;
+            if (p[0] == (counter < 0x100 ? 0x18 | counter : 0x15) && (counter < 0x100 || dir))
+                --adjust;
+            else if (p[0] == (counter < 0x100 ? 0x08 | counter : 0x05) && (counter < 0x100 || dir))
+                ++adjust;
+            else
+                for (int w : Writes(p))
+                    if (w == counter)
+                        return -1;
+            auto it = preds.find(pc);
+            if (pc == entry_ && counter < 8 && (it == preds.end() || it->second.empty()))
+            { // 计数器是参数
+                cur_->params.insert(counter);
+                auto a = args_.find(counter);
+                if (a == args_.end())
+                    return -1;
+                how = "DJNZ arg";
+                return count(a->second);
+            }
+            if (it == preds.end() || it->second.size() != 1)
+                return -1;
+            from = pc;
+            pc = *it->second.begin();
+        }
+        return -1;
+    }
+
+    // bounds.txt 中的注释: 循环头 或 跳回的指令所在的行
+    long Annotated(unsigned head, const std::vector<unsigned>& latches, std::string& where, std::string& how)
+    {
+        where = map_.Where(head);
+        std::vector<std::string> keys = {where};
+        for (unsigned l : latches)
+            keys.push_back(map_.Where(l));
+        for (const std::string& k : keys)
+        {
+            long n = Find(k, how);
+            if (n >= 0)
+                return n;
+        }
+        return -1;
+    }
+
+    // 先找 键@调用者
+    long Find(const std::string& key, std::string& how)
+    {
+        std::vector<std::string> keys = {key};
+        if (!ctx_.empty())
+            keys.insert(keys.begin(), key + "@" + ctx_);
+        for (const std::string& k : keys)
+        {
+            auto it = bounds_.find(k);
+            if (it == bounds_.end())
+                continue;
+            usedBounds.insert(k);
+            how = "bounds";
+            const Fact& fact = it->second;
+            if (fact.lo < 0)
+                return fact.max;
+            cur_->params.insert(fact.lo);
+            if (fact.hi >= 0)
+                cur_->params.insert(fact.hi);
+            auto lo = args_.find(fact.lo), hi = args_.find(fact.hi);
+            if (lo == args_.end() || (fact.hi >= 0 && hi == args_.end()))
+                return fact.max;
+            how = "bounds arg";
+            return static_cast<long>((fact.hi >= 0 ? hi->second << 8 : 0) | lo->second) + fact.offset;
+        }
+        return -1;
+    }
+
+    long Bound(unsigned head, const std::set<unsigned>& body, const std::vector<unsigned>& latches,
+               const std::map<unsigned, std::set<unsigned>>& preds, std::string& where, std::string& how)
+    {
+        where = map_.Where(head);
+        long n = AutoBound(head, body, latches, preds, how);
+        return n >= 0 ? n : Annotated(head, latches, where, how);
+    }
+
+    // 以函数名为键的注释 用于函数中 (含合并进来的公共代码) 其余的循环
+    long Whole(const std::string& func, std::string& how) { return Find(func, how); }
+
+    // 地址所在的函数 (同一个段中 Keil 有时把循环放在入口之前)
+    std::string Owner(unsigned addr) const
+    {
+        const Segment* s = map_.SegmentOf(addr);
+        auto it = map_.entries.upper_bound(addr);
+        if (it != map_.entries.begin() && (!s || std::prev(it)->first >= s->base))
+            return std::prev(it)->second;
+        if (s && it != map_.entries.end() && it->first < s->base + s->length)
+            return it->second;
+        return s && !s->name.empty() ? s->name : Name(addr);
+    }
+
+    // 收缩循环 求最长路径
+    // 循环为强连通分量 循环头取其中逆后序最前的指令 (Keil 的 do-while 会从中间进入 也能处理)
+    void Collapse(unsigned entry, Func& f, Graph& g)
+    {
+        std::map<unsigned, std::set<unsigned>> preds;
+        for (const auto& [u, ss] : g.succ)
+            for (unsigned v : ss)
+                preds[v].insert(u);
+        preds[entry];
+        std::vector<unsigned> order;
+        std::set<unsigned> seen;
+        std::function<void(unsigned)> dfs = [&](unsigned u) {
+            seen.insert(u);
+            for (unsigned v : g.succ[u])
+                if (!seen.count(v))
+                    dfs(v);
+            order.push_back(u);
+        };
+        dfs(entry);
+        std::reverse(order.begin(), order.end());
+        index_.clear();
+        for (size_t i = 0; i < order.size(); ++i)
+            index_[order[i]] = static_cast<int>(i);
+        alive_ = std::set<unsigned>(order.begin(), order.end());
+
+        Reduce(alive_, ~0u, f, g, preds);
+        std::map<unsigned, uint64_t> dist;
+        if (!Longest(entry, alive_, g.succ, g.weight, ~0u, dist))
+        {
+            f.open = true;
+            f.notes.push_back("cannot order the control flow");
+            return;
+        }
+        for (const auto& [u, d] : dist)
+            if (g.succ[u].empty())
+                f.wcet = std::max(f.wcet, d);
+    }
+
+    // 收缩 region 中的循环 (不经过指向 head 的边) 内层先收缩
+    void Reduce(const std::set<unsigned>& region, unsigned head, Func& f, Graph& g,
+                const std::map<unsigned, std::set<unsigned>>& preds)
+    {
+        for (const std::set<unsigned>& scc : Sccs(region, head, g.succ))
+        {
+            unsigned h = *std::min_element(scc.begin(), scc.end(),
+                                           [&](unsigned a, unsigned b) { return index_[a] < index_[b]; });
+            if (scc.size() == 1 && (h == head || !g.succ[h].count(h)))
+                continue;
+            Reduce(scc, h, f, g, preds);
+            Loop(scc, h, f, g, preds);
+        }
+    }
+
+    void Loop(const std::set<unsigned>& scc, unsigned h, Func& f, Graph& g,
+              const std::map<unsigned, std::set<unsigned>>& preds)
+    {
+        auto& succ = g.succ;
+        std::set<unsigned> body, entries = {h};
+        for (unsigned u : scc)
+            if (alive_.count(u))
+                body.insert(u);
+        for (unsigned p : alive_)
+            if (!body.count(p))
+                for (unsigned v : succ[p])
+                    if (body.count(v))
+                        entries.insert(v);
+        std::vector<unsigned> latches;
+        for (unsigned u : body)
+            if (succ[u].count(h))
+                latches.push_back(u);
+
+        std::map<unsigned, uint64_t> dist;
+        Longest(h, body, succ, g.weight, h, dist);
+        uint64_t iter = 0, exit = 0, first = 0;
+        std::set<unsigned> exits;
+        for (unsigned u : latches)
+            iter = std::max(iter, dist[u]);
+        for (unsigned u : body)
+            for (unsigned v : succ[u])
+                if (!body.count(v))
+                {
+                    exit = std::max(exit, dist[u]);
+                    exits.insert(v);
+                }
+        // 从中间进入: 先走一段到跳回或离开
+        for (unsigned e : entries)
+        {
+            if (e == h)
+                continue;
+            std::map<unsigned, uint64_t> d;
+            Longest(e, body, succ, g.weight, h, d);
+            for (const auto& [u, c] : d)
+                first = std::max(first, c);
+        }
+
+        std::string where, how;
+        long bound = entries.size() == 1 ? Bound(h, scc, latches, preds, where, how) : Annotated(h, latches, where, how);
+        if (bound < 0)
+            bound = Whole(f.name, how);
+        if (bound < 0)
+        {
+            f.open = true;
+            f.notes.push_back(exits.empty() ? "endless loop at " + where : "unbounded loop at " + where);
+        }
+        loops.push_back({where, Owner(h) + (ctx_.empty() ? "" : "@" + ctx_) + (args_.empty() ? "" : Describe(args_)),
+                         how, bound, iter});
+        uint64_t n = bound > 0 ? static_cast<uint64_t>(bound) : 1;
+        g.weight[h] = first + (n - 1) * iter + (exits.empty() ? iter : exit);
+
+        // 整个循环成为一个节点 h
+        for (unsigned p : alive_)
+            if (!body.count(p))
+            {
+                std::set<unsigned>& ss = succ[p];
+                bool into = false;
+                for (auto it = ss.begin(); it != ss.end();)
+                    if (body.count(*it))
+                        it = ss.erase(it), into = true;
+                    else
+                        ++it;
+                if (into)
+                    ss.insert(h);
+            }
+        for (unsigned u : body)
+            if (u != h)
+                alive_.erase(u);
+        succ[h] = exits;
+    }
+
+    // region 中的强连通分量 (Tarjan) 忽略指向 head 的边
+    static std::vector<std::set<unsigned>> Sccs(const std::set<unsigned>& region, unsigned head,
+                                                std::map<unsigned, std::set<unsigned>>& succ)
+    {
+        std::vector<std::set<unsigned>> out;
+        std::map<unsigned, int> num, low;
+        std::vector<unsigned> stack;
+        std::set<unsigned> onStack;
+        int counter = 0;
+        std::function<void(unsigned)> visit = [&](unsigned u) {
+            num[u] = low[u] = ++counter;
+            stack.push_back(u);
+            onStack.insert(u);
+            for (unsigned v : succ[u])
+            {
+                if (v == head || !region.count(v))
+                    continue;
+                if (!num.count(v))
+                {
+                    visit(v);
+                    low[u] = std::min(low[u], low[v]);
+                }
+                else if (onStack.count(v))
+                    low[u] = std::min(low[u], num[v]);
+            }
+            if (low[u] == num[u])
+            {
+                std::set<unsigned> scc;
+                unsigned v;
+                do
+                {
+                    v = stack.back();
+                    stack.pop_back();
+                    onStack.erase(v);
+                    scc.insert(v);
+                } while (v != u);
+                out.push_back(scc);
+            }
+        };
+        for (unsigned u : region)
+            if (!num.count(u))
+                visit(u);
+        return out;
+    }
+    // 在 nodes 中从 from 出发的最长路径 (不走进 skip) 有环时返回 false
+    static bool Longest(unsigned from, const std::set<unsigned>& nodes, std::map<unsigned, std::set<unsigned>>& succ,
+                        std::map<unsigned, uint64_t>& weight, unsigned skip, std::map<unsigned, uint64_t>& dist)
+    {
+        std::vector<unsigned> topo;
+        std::map<unsigned, int> mark; // 1 访问中 2 完成
+        bool acyclic = true;
+        std::function<void(unsigned)> visit = [&](unsigned u) {
+            mark[u] = 1;
+            for (unsigned v : succ[u])
+            {
+                if (v == skip || !nodes.count(v))
+                    continue;
+                if (mark[v] == 1)
+                    acyclic = false;
+                else if (!mark[v])
+                    visit(v);
+            }
+            mark[u] = 2;
+            topo.push_back(u);
+        };
+        visit(from);
+        std::reverse(topo.begin(), topo.end());
+        dist[from] = weight[from];
+        for (unsigned u : topo)
+            for (unsigned v : succ[u])
+                if (v != skip && nodes.count(v))
+                    dist[v] = std::max(dist[v], dist[u] + weight[v]);
+        return acyclic;
+    }
+
+    const std::vector<uint8_t>& code_;
+    unsigned top_;
+    const MapFile& map_;
+    const std::map<std::string, Fact>& bounds_;
+    bool recursion_ = false;
+    std::set<std::string> callers_; // bounds.txt 中 @ 后的调用者
+    std::string ctx_;               // 正在收缩的函数的调用者
+    Args args_;                     // 及其为常数的参数
+    Func* cur_ = nullptr;
+    unsigned entry_ = 0;
+    std::map<unsigned, int> index_; // 逆后序
+    std::set<unsigned> alive_;      // 还没有被收缩进循环的指令
+};
+
+std::string Cycles(const Func& f)
+{
+    return std::to_string(f.wcet) + (f.open ? "+" : "");
+}
+
+// 键 上限 [参数寄存器[+-偏移]] 例如 ULTIMATE:37 401 R6R7+1
+bool LoadBounds(const std::string& path, std::map<std::string, Fact>& bounds)
+{
+    std::ifstream in(path);
+    if (!in)
+        return false;
+    static const std::regex arg(R"(^R([0-7])(?:R([0-7]))?([+-]\d+)?$)");
+    std::string line, key, expr;
+    long n;
+    std::smatch m;
+    while (std::getline(in, line))
+    {
+        std::istringstream ss(line.substr(0, line.find('#')));
+        if (!(ss >> key >> n))
+            continue;
+        Fact fact{n};
+        if (ss >> expr && std::regex_match(expr, m, arg))
+        {
+            fact.lo = m[2].matched ? std::stoi(m[2]) : std::stoi(m[1]);
+            fact.hi = m[2].matched ? std::stoi(m[1]) : -1;
+            fact.offset = m[3].matched ? std::stol(m[3]) : 0;
+        }
+        bounds[key] = fact;
+    }
+    return true;
+}
+
+// 上次报告中 interrupts functions 两节的 名字 周期 (中断的名字为 "INT0 int_X0")
+std::map<std::string, std::string> LoadPrevious(const std::string& path)
+{
+    std::map<std::string, std::string> prev;
+    std::ifstream in(path);
+    std::string line, section, name, isr, cycles;
+    while (std::getline(in, line))
+    {
+        if (line.empty())
+            section.clear();
+        else if (line[0] != ' ')
+            section = line.substr(0, line.find(' '));
+        else
+        {
+            std::istringstream ss(line);
+            if (section == "interrupts" && ss >> name >> isr >> cycles)
+                prev[name + " " + isr] = cycles;
+            else if (section == "functions" && ss >> name >> cycles)
+                prev[name] = cycles;
+        }
+    }
+    return prev;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    double mhz = 11.0592;
+    std::string boundsPath, prevPath;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string a = argv[i];
+        if (a == "-c" && i + 1 < argc)
+            mhz = std::atof(argv[++i]);
+        else if (a == "-b" && i + 1 < argc)
+            boundsPath = argv[++i];
+        else if (a == "-p" && i + 1 < argc)
+            prevPath = argv[++i];
+        else if (a[0] != '-')
+            files.push_back(a);
+        else
+            files.clear(), i = argc;
+    }
+    if (files.size() != 2 || mhz <= 0)
+    {
+        std::cerr << "usage: wcet51 [-c crystal_mhz] [-b bounds.txt] [-p previous_report] file.m51 file.hex\n";
+        return 2;
+    }
+
+    MapFile map;
+    std::vector<uint8_t> code(65536, 0xff);
+    unsigned top;
+    std::map<std::string, Fact> bounds;
+    if (!map.Load(files[0]))
+    {
+        std::cerr << "wcet51: cannot open " << files[0] << '\n';
+        return 1;
+    }
+    if (!LoadHex(files[1], code, top))
+    {
+        std::cerr << "wcet51: cannot open " << files[1] << '\n';
+        return 1;
+    }
+    if (!boundsPath.empty() && !LoadBounds(boundsPath, bounds))
+    {
+        std::cerr << "wcet51: cannot open " << boundsPath << '\n';
+        return 1;
+    }
+
+    Analyzer an(code, top, map, bounds);
+    double us = 12 / mhz;
+    std::printf("wcet51: %s  %g MHz (1 cycle = %.3f us)\n", files[1].c_str(), mhz, us);
+    std::printf("machine cycles, \"+\" = includes loops without a bound (counted once) or unknown jumps\n\n");
+
+    // 中断: 从向量开始 (含向量处的 LJMP) 另加硬件响应的 2 个周期 与压入的 2 字节
+    static const char* const vectors[] = {"INT0", "T0", "INT1", "T1", "UART", "T2"};
+    std::map<std::string, std::string> now; // 用于 -p
+    std::printf("interrupts                          cycles          us  stack\n");
+    for (int i = 0; i < 6; ++i)
+    {
+        unsigned v = i * 8 + 3;
+        if (!map.vectors.count(v))
+            continue;
+        int target = i8051::Target(code.data(), static_cast<uint16_t>(v));
+        const Func& f = an.Analyze(v);
+        Func isr = f;
+        isr.wcet += 2;
+        std::string name = target >= 0 ? an.Name(target) : "?";
+        std::printf("  %-5s %-24s %10s %11.1f %6d\n", vectors[i], name.c_str(), Cycles(isr).c_str(), isr.wcet * us,
+                    isr.stack + 2);
+        now[std::string(vectors[i]) + " " + name] = Cycles(isr);
+    }
+
+    for (const auto& [addr, name] : map.entries)
+        if (addr < top)
+            an.Analyze(addr);
+    std::map<std::string, const Func*> byName;
+    for (const auto& [key, f] : an.funcs)
+        if (key.second.empty() && map.entries.count(key.first))
+            byName[f.name] = &f;
+    std::printf("\nfunctions                           cycles          us  stack\n");
+    for (const auto& [name, f] : byName)
+    {
+        std::printf("  %-30s %10s %11.1f %6d\n", name.c_str(), Cycles(*f).c_str(), f->wcet * us, f->stack);
+        now[name] = Cycles(*f);
+    }
+
+    // 公共代码中的循环在每个用到它的函数中都会找到一次
+    auto key = [](const LoopInfo& l) { return std::tie(l.where, l.func, l.bound, l.how, l.iter); };
+    std::sort(an.loops.begin(), an.loops.end(), [&](const LoopInfo& a, const LoopInfo& b) { return key(a) < key(b); });
+    an.loops.erase(std::unique(an.loops.begin(), an.loops.end(),
+                               [&](const LoopInfo& a, const LoopInfo& b) { return key(a) == key(b); }),
+                   an.loops.end());
+    std::printf("\nloops                        function                                bound  cycles/iter\n");
+    for (const LoopInfo& l : an.loops)
+    {
+        std::string bound = l.bound < 0 ? "?" : std::to_string(l.bound) + " " + l.how;
+        std::printf("  %-26s %-38s %-13s %8llu\n", l.where.c_str(), l.func.c_str(), bound.c_str(),
+                    static_cast<unsigned long long>(l.iter));
+    }
+
+    std::printf("\nnotes\n");
+    for (const auto& [name, f] : byName)
+        for (const std::string& n : f->notes)
+            std::printf("  %-30s %s\n", name.c_str(), n.c_str());
+    for (const auto& [key, fact] : bounds)
+        if (!an.usedBounds.count(key))
+            std::printf("  bounds: %s %ld matches no loop\n", key.c_str(), fact.max);
+
+    if (!prevPath.empty())
+    {
+        auto prev = LoadPrevious(prevPath);
+        std::printf("\nchanges against %s\n", prevPath.c_str());
+        for (const auto& [name, cycles] : now)
+        {
+            auto it = prev.find(name);
+            if (it == prev.end())
+                std::printf("  %-30s %10s  (new)\n", name.c_str(), cycles.c_str());
+            else if (it->second != cycles)
+            {
+                long delta = std::atol(cycles.c_str()) - std::atol(it->second.c_str());
+                std::printf("  %-30s %10s -> %-10s %+ld\n", name.c_str(), it->second.c_str(), cycles.c_str(), delta);
+            }
+        }
+        for (const auto& [name, cycles] : prev)
+            if (!now.count(name))
+                std::printf("  %-30s %10s  (removed)\n", name.c_str(), cycles.c_str());
+    }
+    return 0;
+}